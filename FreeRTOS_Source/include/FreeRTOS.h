@@ -268,6 +268,12 @@ extern "C" {
 	#define configIDLE_SHOULD_YIELD		1
 #endif
 
+/* Tick count the scheduler starts from, set close to the wrap to exercise
+the code that compares tick counts. */
+#ifndef configINITIAL_TICK_COUNT
+	#define configINITIAL_TICK_COUNT	0
+#endif
+
 #if configMAX_TASK_NAME_LEN < 1
 	#error configMAX_TASK_NAME_LEN must be set to a minimum of 1 in FreeRTOSConfig.h
 #endif
@@ -768,6 +774,19 @@ extern "C" {
 	#define configUSE_TASK_NOTIFICATIONS 1
 #endif
 
+#ifndef configUSE_EDF_SCHEDULING
+	#define configUSE_EDF_SCHEDULING 0
+#endif
+
+#if ( configUSE_EDF_SCHEDULING == 1 )
+	#ifndef configEDF_PRIORITY
+		#error configEDF_PRIORITY must be defined to the priority band scheduled by deadline when configUSE_EDF_SCHEDULING is set to 1.
+	#endif
+	#if ( configEDF_PRIORITY >= configMAX_PRIORITIES )
+		#error configEDF_PRIORITY must be lower than configMAX_PRIORITIES.
+	#endif
+#endif
+
 #ifndef portTICK_TYPE_IS_ATOMIC
 	#define portTICK_TYPE_IS_ATOMIC 0
 #endif
@@ -945,6 +964,9 @@ typedef struct xSTATIC_TCB
 		uint32_t 		ulDummy18;
 		uint8_t 		ucDummy19;
 	#endif
+	#if ( configUSE_EDF_SCHEDULING == 1 )
+		TickType_t		xDummy21;
+	#endif
 	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 		uint8_t			uxDummy20;
 	#endif
@@ -949,6 +949,64 @@ void vTaskGetInfo( TaskHandle_t xTask, TaskStatus_t *pxTaskStatus, BaseType_t xG
  */
 void vTaskPrioritySet( TaskHandle_t xTask, UBaseType_t uxNewPriority ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <pre>void vTaskSetDeadline( TaskHandle_t xTask, TickType_t xDeadline );</pre>
+ *
+ * configUSE_EDF_SCHEDULING must be defined as 1 for this function to be
+ * available.  See the configuration section for more information.
+ *
+ * Set the absolute deadline, in ticks, of any task.  Ready tasks that have the
+ * priority configEDF_PRIORITY are kept in deadline order, and the one with the
+ * earliest deadline is the one that runs.  Tasks in other priorities are not
+ * affected by their deadline.  A task that never had its deadline set has a
+ * deadline of portMAX_DELAY.
+ *
+ * A context switch will occur before the function returns if the deadline
+ * being set changes which task of the EDF band should be running.
+ *
+ * @param xTask Handle to the task for which the deadline is being set.
+ * Passing a NULL handle results in the deadline of the calling task being set.
+ *
+ * @param xDeadline The absolute deadline, as a tick count.
+ *
+ * Example usage:
+   <pre>
+ void vAFunction( void )
+ {
+ TaskHandle_t xHandle;
+
+	 // Create a task in the EDF band, storing the handle.
+	 xTaskCreate( vTaskCode, "NAME", STACK_SIZE, NULL, configEDF_PRIORITY, &xHandle );
+
+	 // ...
+
+	 // The task must complete within 100 ms from now.
+	 vTaskSetDeadline( xHandle, xTaskGetTickCount() + pdMS_TO_TICKS( 100 ) );
+ }
+   </pre>
+ * \defgroup vTaskSetDeadline vTaskSetDeadline
+ * \ingroup TaskCtrl
+ */
+void vTaskSetDeadline( TaskHandle_t xTask, TickType_t xDeadline ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>TickType_t xTaskGetDeadline( TaskHandle_t xTask );</pre>
+ *
+ * configUSE_EDF_SCHEDULING must be defined as 1 for this function to be
+ * available.  See the configuration section for more information.
+ *
+ * @param xTask Handle of the task to be queried.  Passing a NULL
+ * handle results in the deadline of the calling task being returned.
+ *
+ * @return The absolute deadline of xTask, as set by vTaskSetDeadline().
+ *
+ * \defgroup xTaskGetDeadline xTaskGetDeadline
+ * \ingroup TaskCtrl
+ */
+TickType_t xTaskGetDeadline( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <pre>void vTaskSuspend( TaskHandle_t xTaskToSuspend );</pre>
@@ -0,0 +1,313 @@
+/*
+    Simulated tick port for POSIX hosts, see portmacro.h.
+
+    1 tab == 4 spaces!
+*/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the POSIX simulated
+ * tick port.
+ *
+ * A context switch hands a baton from one pthread to the next: the outgoing
+ * thread marks the incoming one as running, signals it, and waits on its own
+ * condition variable until it is marked running again.  Only the thread that
+ * holds the baton touches kernel data, so no further locking is needed.
+ *
+ * Context switches and ticks only happen while no critical section is held,
+ * as on the Cortex-M where PendSV and SysTick stay masked by BASEPRI.  A yield
+ * requested inside a critical section is taken when it is left.
+ *----------------------------------------------------------*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Ticks to run for when the DD_SIM_TICKS environment variable is not set. */
+#ifndef configSIM_DEFAULT_RUN_TICKS
+	#define configSIM_DEFAULT_RUN_TICKS	10000
+#endif
+
+/* Value of the critical nesting before the scheduler starts, so that
+interrupts stay masked until then. */
+#define portINITIAL_CRITICAL_NESTING	( ( UBaseType_t ) 0xaaaaaaaa )
+
+/* The thread that runs a task.  It lives at the top of the task's stack, and
+pxPortInitialiseStack() returns its address as the task's top of stack. */
+typedef struct SimThread
+{
+	pthread_t xThread;
+	pthread_cond_t xCond;
+	BaseType_t xRunning;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+} SimThread_t;
+
+/* The kernel's current TCB, whose first member is the top of stack. */
+extern void * volatile pxCurrentTCB;
+
+static pthread_mutex_t xSimMutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile UBaseType_t uxCriticalNesting = portINITIAL_CRITICAL_NESTING;
+static volatile BaseType_t xInterruptsMasked = pdTRUE;
+static volatile BaseType_t xInsideInterrupt = pdFALSE;
+static volatile BaseType_t xYieldPending = pdFALSE;
+static BaseType_t xSchedulerRunning = pdFALSE;
+static uint32_t ulQuanta = 0;
+static TickType_t xRunTicks = configSIM_DEFAULT_RUN_TICKS;
+
+/*
+ * Entry point of every task thread.
+ */
+static void *prvThreadEntry( void *pvParameters );
+
+/*
+ * Hand the baton from one thread to another.
+ */
+static void prvSwitchThreads( SimThread_t *pxFrom, SimThread_t *pxTo );
+
+/*
+ * Select the next task and switch to its thread.
+ */
+static void prvYieldNow( void );
+
+/*
+ * Run the simulated tick interrupt.
+ */
+static void prvTickInterrupt( void );
+
+/*
+ * Called each time a task leaves its outermost critical section.
+ */
+static void prvSafePoint( void );
+
+/*-----------------------------------------------------------*/
+
+static SimThread_t *prvCurrentThread( void )
+{
+	return *( SimThread_t ** ) pxCurrentTCB;
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+SimThread_t *pxThread;
+pthread_attr_t xAttr;
+
+	/* The stack itself is never used, the thread has its own. */
+	pxThread = ( SimThread_t * ) ( ( ( uintptr_t ) pxTopOfStack - sizeof( SimThread_t ) ) & ~( ( uintptr_t ) portBYTE_ALIGNMENT - 1 ) );
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pxThread->xRunning = pdFALSE;
+	pthread_cond_init( &( pxThread->xCond ), NULL );
+
+	pthread_attr_init( &xAttr );
+	pthread_attr_setdetachstate( &xAttr, PTHREAD_CREATE_DETACHED );
+	if( pthread_create( &( pxThread->xThread ), &xAttr, prvThreadEntry, pxThread ) != 0 )
+	{
+		fprintf( stderr, "Posix_SimTick: cannot create a task thread\n" );
+		exit( EXIT_FAILURE );
+	}
+	pthread_attr_destroy( &xAttr );
+
+	return ( StackType_t * ) pxThread;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParameters )
+{
+SimThread_t *pxThread = ( SimThread_t * ) pvParameters;
+
+	pthread_mutex_lock( &xSimMutex );
+	while( pxThread->xRunning == pdFALSE )
+	{
+		pthread_cond_wait( &( pxThread->xCond ), &xSimMutex );
+	}
+	pthread_mutex_unlock( &xSimMutex );
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Tasks must not return. */
+	fprintf( stderr, "Posix_SimTick: a task function returned\n" );
+	exit( EXIT_FAILURE );
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThreads( SimThread_t *pxFrom, SimThread_t *pxTo )
+{
+	pthread_mutex_lock( &xSimMutex );
+	pxTo->xRunning = pdTRUE;
+	pthread_cond_signal( &( pxTo->xCond ) );
+	if( pxFrom != NULL )
+	{
+		pxFrom->xRunning = pdFALSE;
+		while( pxFrom->xRunning == pdFALSE )
+		{
+			pthread_cond_wait( &( pxFrom->xCond ), &xSimMutex );
+		}
+	}
+	pthread_mutex_unlock( &xSimMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldNow( void )
+{
+SimThread_t *pxFrom = prvCurrentThread();
+SimThread_t *pxTo;
+
+	xYieldPending = pdFALSE;
+	vTaskSwitchContext();
+	pxTo = prvCurrentThread();
+	if( pxTo != pxFrom )
+	{
+		prvSwitchThreads( pxFrom, pxTo );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickInterrupt( void )
+{
+	xInsideInterrupt = pdTRUE;
+	xInterruptsMasked = pdTRUE;
+	if( xTaskIncrementTick() != pdFALSE )
+	{
+		xYieldPending = pdTRUE;
+	}
+	if( ( TickType_t ) ( xTaskGetTickCountFromISR() - configINITIAL_TICK_COUNT ) >= xRunTicks )
+	{
+		vPortEndScheduler();
+	}
+	xInterruptsMasked = pdFALSE;
+	xInsideInterrupt = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSafePoint( void )
+{
+	if( ( xSchedulerRunning == pdFALSE ) || ( xInsideInterrupt != pdFALSE ) )
+	{
+		return;
+	}
+
+	if( ++ulQuanta >= configSIM_QUANTA_PER_TICK )
+	{
+		ulQuanta = 0;
+		prvTickInterrupt();
+	}
+
+	if( xYieldPending != pdFALSE )
+	{
+		prvYieldNow();
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+const char *pcRunTicks = getenv( "DD_SIM_TICKS" );
+
+	if( pcRunTicks != NULL )
+	{
+		xRunTicks = ( TickType_t ) strtoul( pcRunTicks, NULL, 10 );
+	}
+
+	xSchedulerRunning = pdTRUE;
+	uxCriticalNesting = 0;
+	xInterruptsMasked = pdFALSE;
+
+	/* Start the first task, this thread then only waits for the exit. */
+	prvSwitchThreads( NULL, prvCurrentThread() );
+	for( ;; )
+	{
+		pause();
+	}
+
+	/* Should not get here. */
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	fflush( stdout );
+	exit( EXIT_SUCCESS );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	xYieldPending = pdTRUE;
+	if( ( uxCriticalNesting == 0 ) && ( xInsideInterrupt == pdFALSE ) && ( xSchedulerRunning != pdFALSE ) )
+	{
+		prvYieldNow();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	/* Taken once the interrupt, or the critical section, is left. */
+	xYieldPending = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	xInterruptsMasked = pdTRUE;
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		xInterruptsMasked = pdFALSE;
+		prvSafePoint();
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t ulPortSetInterruptMask( void )
+{
+UBaseType_t uxWasMasked = ( UBaseType_t ) xInterruptsMasked;
+
+	xInterruptsMasked = pdTRUE;
+	return uxWasMasked;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxMask )
+{
+	xInterruptsMasked = ( BaseType_t ) uxMask;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortIsInsideInterrupt( void )
+{
+	return xInsideInterrupt;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSimIdle( void )
+{
+	if( ( uxCriticalNesting != 0 ) || ( xSchedulerRunning == pdFALSE ) )
+	{
+		return;
+	}
+
+	ulQuanta = 0;
+	prvTickInterrupt();
+	if( xYieldPending != pdFALSE )
+	{
+		prvYieldNow();
+	}
+}
+/*-----------------------------------------------------------*/
+
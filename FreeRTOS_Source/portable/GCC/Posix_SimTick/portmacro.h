@@ -0,0 +1,122 @@
+/*
+    Simulated tick port for POSIX hosts.
+
+    Every task runs in its own pthread, but only the thread of pxCurrentTCB is
+    ever allowed to run, so the kernel sees a single core.  There is no tick
+    interrupt: the tick is raised synchronously, in the running task, each
+    time configSIM_QUANTA_PER_TICK critical sections have been left, or at
+    once when the idle task calls vPortSimIdle().  Simulated time is therefore
+    deterministic and runs as fast as the host can execute the kernel.
+
+    1 tab == 4 spaces!
+*/
+
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The settings in this file configure FreeRTOS correctly for the
+ * given hardware and compiler.
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	uintptr_t
+#define portBASE_TYPE	long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+	typedef uint32_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+
+	/* portTICK_TYPE_IS_ATOMIC is deliberately left at 0.  Reads of the tick
+	count then go through a critical section, which is where a task that polls
+	the tick count lets simulated time move on. */
+#endif
+/*-----------------------------------------------------------*/
+
+/* Number of critical sections left by tasks that make up one tick.  A task
+busy waiting on the tick count leaves one critical section per poll, and the
+application workload one per block of work it executes. */
+#ifndef configSIM_QUANTA_PER_TICK
+	#define configSIM_QUANTA_PER_TICK	50
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+#define portPOINTER_SIZE_TYPE		uintptr_t
+/*-----------------------------------------------------------*/
+
+/* Scheduler utilities. */
+extern void vPortYield( void );
+extern void vPortYieldFromISR( void );
+#define portYIELD()									vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired )	if( xSwitchRequired != pdFALSE ) vPortYieldFromISR()
+#define portYIELD_FROM_ISR( x )						portEND_SWITCHING_ISR( x )
+/*-----------------------------------------------------------*/
+
+/* Critical section management. */
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+extern UBaseType_t ulPortSetInterruptMask( void );
+extern void vPortClearInterruptMask( UBaseType_t uxMask );
+#define portSET_INTERRUPT_MASK_FROM_ISR()		ulPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	vPortClearInterruptMask(x)
+#define portDISABLE_INTERRUPTS()				( void ) ulPortSetInterruptMask()
+#define portENABLE_INTERRUPTS()					vPortClearInterruptMask( pdFALSE )
+#define portENTER_CRITICAL()					vPortEnterCritical()
+#define portEXIT_CRITICAL()						vPortExitCritical()
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+/*-----------------------------------------------------------*/
+
+/* portNOP() is not required by this port. */
+#define portNOP()
+
+#define portINLINE	__inline
+
+#ifndef portFORCE_INLINE
+	#define portFORCE_INLINE inline __attribute__(( always_inline))
+#endif
+
+/* pdTRUE while the simulated tick interrupt, and the tick hook called from it,
+are running. */
+extern BaseType_t xPortIsInsideInterrupt( void );
+
+/* Called by the idle task when it has nothing to do, the equivalent of a wait
+for interrupt: the rest of the current tick is skipped. */
+extern void vPortSimIdle( void );
+/*-----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
+
@@ -153,6 +153,50 @@ a statically allocated stack and a dynamically allocated TCB. */
 	#define static
 #endif
 
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	/* The ready list of the configEDF_PRIORITY band is kept sorted by absolute
+	deadline, so the task to run in that band is always the head of the list.
+	Other priorities keep the normal round robin behaviour. */
+	#define taskSELECT_FROM_READY_LIST( uxTopPriority )															\
+	{																											\
+		if( ( uxTopPriority ) == ( UBaseType_t ) configEDF_PRIORITY )											\
+		{																										\
+			pxCurrentTCB = ( TCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxReadyTasksLists[ uxTopPriority ] ) );	\
+		}																										\
+		else																									\
+		{																										\
+			listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );				\
+		}																										\
+	}
+
+	/* Deadline xA is earlier than deadline xB.  Deadlines wrap with the tick
+	count, so they are compared by their difference, and portMAX_DELAY (no
+	deadline) comes after every deadline. */
+	#define taskDEADLINE_BEFORE( xA, xB )																		\
+		( ( ( xA ) != portMAX_DELAY ) &&																		\
+		  ( ( ( xB ) == portMAX_DELAY ) || ( ( int32_t ) ( ( xA ) - ( xB ) ) < 0 ) ) )
+
+	/* A task preempts the running task if it has a higher priority, or if both
+	are in the EDF band and it has an earlier deadline. */
+	#define taskPREEMPTS_CURRENT_TASK( pxTCB )																	\
+		( ( ( pxTCB )->uxPriority > pxCurrentTCB->uxPriority ) ||												\
+		  ( ( ( pxTCB )->uxPriority == ( UBaseType_t ) configEDF_PRIORITY ) &&									\
+			( pxCurrentTCB->uxPriority == ( UBaseType_t ) configEDF_PRIORITY ) &&								\
+			taskDEADLINE_BEFORE( ( pxTCB )->xDeadline, pxCurrentTCB->xDeadline ) ) )
+
+#else /* configUSE_EDF_SCHEDULING */
+
+	/* listGET_OWNER_OF_NEXT_ENTRY indexes through the list, so the tasks of
+	the	same priority get an equal share of the processor time. */
+	#define taskSELECT_FROM_READY_LIST( uxTopPriority )	listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) )
+
+	#define taskPREEMPTS_CURRENT_TASK( pxTCB ) ( ( pxTCB )->uxPriority > pxCurrentTCB->uxPriority )
+
+#endif /* configUSE_EDF_SCHEDULING */
+
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
 
 	/* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 0 then task selection is
@@ -182,9 +226,10 @@ a statically allocated stack and a dynamically allocated TCB. */
 			--uxTopPriority;																			\
 		}																								\
 																										\
-		/* listGET_OWNER_OF_NEXT_ENTRY indexes through the list, so the tasks of						\
-		the	same priority get an equal share of the processor time. */									\
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );			\
+		/* taskSELECT_FROM_READY_LIST indexes through the list, so the tasks of						\
+		the	same priority get an equal share of the processor time, except in						\
+		the EDF band where the earliest deadline always runs. */										\
+		taskSELECT_FROM_READY_LIST( uxTopPriority );													\
 		uxTopReadyPriority = uxTopPriority;																\
 	} /* taskSELECT_HIGHEST_PRIORITY_TASK */
 
@@ -214,7 +259,7 @@ a statically allocated stack and a dynamically allocated TCB. */
 		/* Find the highest priority list that contains ready tasks. */								\
 		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );								\
 		configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 );		\
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );		\
+		taskSELECT_FROM_READY_LIST( uxTopPriority );												\
 	} /* taskSELECT_HIGHEST_PRIORITY_TASK() */
 
 	/*-----------------------------------------------------------*/
@@ -254,13 +299,30 @@ count overflows. */
 
 /*
  * Place the task represented by pxTCB into the appropriate ready list for
- * the task.  It is inserted at the end of the list.
+ * the task.  It is inserted at the end of the list, or in deadline order if
+ * the task is in the EDF priority band.
  */
-#define prvAddTaskToReadyList( pxTCB )																\
-	traceMOVED_TASK_TO_READY_STATE( pxTCB );														\
-	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );												\
-	vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
-	tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB )
+#if ( configUSE_EDF_SCHEDULING == 1 )
+	#define prvAddTaskToReadyList( pxTCB )																\
+		traceMOVED_TASK_TO_READY_STATE( pxTCB );														\
+		taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );												\
+		if( ( pxTCB )->uxPriority == ( UBaseType_t ) configEDF_PRIORITY )								\
+		{																								\
+			listSET_LIST_ITEM_VALUE( &( ( pxTCB )->xStateListItem ), ( pxTCB )->xDeadline );			\
+			prvInsertByDeadline( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
+		}																								\
+		else																							\
+		{																								\
+			vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
+		}																								\
+		tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB )
+#else
+	#define prvAddTaskToReadyList( pxTCB )																\
+		traceMOVED_TASK_TO_READY_STATE( pxTCB );														\
+		taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );												\
+		vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
+		tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB )
+#endif /* configUSE_EDF_SCHEDULING */
 /*-----------------------------------------------------------*/
 
 /*
@@ -350,6 +412,10 @@ typedef struct tskTaskControlBlock
 		volatile uint8_t ucNotifyState;
 	#endif
 
+	#if( configUSE_EDF_SCHEDULING == 1 )
+		TickType_t		xDeadline;			/*< Absolute deadline used to order the ready list of the configEDF_PRIORITY band. */
+	#endif
+
 	/* See the comments above the definition of
 	tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE. */
 	#if( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 )
@@ -394,7 +460,7 @@ PRIVILEGED_DATA static List_t xPendingReadyList;						/*< Tasks that have been r
 
 /* Other file private variables. --------------------------------*/
 PRIVILEGED_DATA static volatile UBaseType_t uxCurrentNumberOfTasks 	= ( UBaseType_t ) 0U;
-PRIVILEGED_DATA static volatile TickType_t xTickCount 				= ( TickType_t ) 0U;
+PRIVILEGED_DATA static volatile TickType_t xTickCount 				= ( TickType_t ) configINITIAL_TICK_COUNT;
 PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning 		= pdFALSE;
 PRIVILEGED_DATA static volatile UBaseType_t uxPendedTicks 			= ( UBaseType_t ) 0U;
@@ -579,6 +645,17 @@ static void prvInitialiseNewTask( 	TaskFunction_t pxTaskCode,
  */
 static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	/*
+	 * Insert a ready list item of the EDF band in deadline order, after the
+	 * items of the same deadline.  vListInsert() compares the item values
+	 * directly, which breaks once the deadlines wrap with the tick count.
+	 */
+	static void prvInsertByDeadline( List_t * const pxList, ListItem_t * const pxNewListItem ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 #if( configSUPPORT_STATIC_ALLOCATION == 1 )
@@ -867,6 +944,13 @@ UBaseType_t x;
 	vListInitialiseItem( &( pxNewTCB->xStateListItem ) );
 	vListInitialiseItem( &( pxNewTCB->xEventListItem ) );
 
+	#if ( configUSE_EDF_SCHEDULING == 1 )
+	{
+		/* A task without a deadline runs after every task that has one. */
+		pxNewTCB->xDeadline = portMAX_DELAY;
+	}
+	#endif /* configUSE_EDF_SCHEDULING */
+
 	/* Set the pxNewTCB as a link back from the ListItem_t.  This is so we can get
 	back to	the containing TCB from a generic item in a list. */
 	listSET_LIST_ITEM_OWNER( &( pxNewTCB->xStateListItem ), pxNewTCB );
@@ -1027,7 +1111,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 	{
 		/* If the created task is of a higher priority than the current task
 		then it should run now. */
-		if( pxCurrentTCB->uxPriority < pxNewTCB->uxPriority )
+		if( taskPREEMPTS_CURRENT_TASK( pxNewTCB ) )
 		{
 			taskYIELD_IF_USING_PREEMPTION();
 		}
@@ -1561,6 +1645,108 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 #endif /* INCLUDE_vTaskPrioritySet */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	void vTaskSetDeadline( TaskHandle_t xTask, TickType_t xDeadline )
+	{
+	TCB_t *pxTCB;
+	BaseType_t xYieldRequired = pdFALSE;
+
+		taskENTER_CRITICAL();
+		{
+			/* If null is passed in here then it is the deadline of the calling
+			task that is being changed. */
+			pxTCB = prvGetTCBFromHandle( xTask );
+			pxTCB->xDeadline = xDeadline;
+
+			/* If the task is ready in the EDF band it is moved to its new
+			position in the deadline ordered ready list. */
+			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ configEDF_PRIORITY ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+			{
+				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+				prvAddTaskToReadyList( pxTCB );
+
+				/* The running task may no longer have the earliest deadline,
+				or the task may now have an earlier deadline than the running
+				task. */
+				if( ( pxTCB == pxCurrentTCB ) || taskPREEMPTS_CURRENT_TASK( pxTCB ) )
+				{
+					xYieldRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xYieldRequired != pdFALSE )
+		{
+			taskYIELD_IF_USING_PREEMPTION();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configUSE_EDF_SCHEDULING */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	TickType_t xTaskGetDeadline( TaskHandle_t xTask )
+	{
+	TCB_t *pxTCB;
+	TickType_t xReturn;
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			xReturn = pxTCB->xDeadline;
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_EDF_SCHEDULING */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	static void prvInsertByDeadline( List_t * const pxList, ListItem_t * const pxNewListItem )
+	{
+	ListItem_t *pxIterator;
+	const ListItem_t * const pxEnd = ( ListItem_t * ) &( pxList->xListEnd ); /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+	const TickType_t xDeadline = listGET_LIST_ITEM_VALUE( pxNewListItem );
+
+		listTEST_LIST_INTEGRITY( pxList );
+		listTEST_LIST_ITEM_INTEGRITY( pxNewListItem );
+
+		for( pxIterator = ( ListItem_t * ) pxEnd; ( pxIterator->pxNext != pxEnd ) && !taskDEADLINE_BEFORE( xDeadline, pxIterator->pxNext->xItemValue ); pxIterator = pxIterator->pxNext )
+		{
+			/* There is nothing to do here, just iterating to the wanted
+			insertion position. */
+		}
+
+		pxNewListItem->pxNext = pxIterator->pxNext;
+		pxNewListItem->pxNext->pxPrevious = pxNewListItem;
+		pxNewListItem->pxPrevious = pxIterator;
+		pxIterator->pxNext = pxNewListItem;
+		pxNewListItem->pvContainer = ( void * ) pxList;
+
+		( pxList->uxNumberOfItems )++;
+	}
+
+#endif /* configUSE_EDF_SCHEDULING */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_vTaskSuspend == 1 )
 
 	void vTaskSuspend( TaskHandle_t xTaskToSuspend )
@@ -1897,7 +2083,7 @@ BaseType_t xReturn;
 
 		xNextTaskUnblockTime = portMAX_DELAY;
 		xSchedulerRunning = pdTRUE;
-		xTickCount = ( TickType_t ) 0U;
+		xTickCount = ( TickType_t ) configINITIAL_TICK_COUNT;
 
 		/* If configGENERATE_RUN_TIME_STATS is defined then the following
 		macro must be defined to configure the timer/counter used to generate
@@ -2470,7 +2656,7 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 					/* Preemption is on, but a context switch should only be
 					performed if the unblocked task has a priority that is
 					equal to or higher than the currently executing task. */
-					if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+					if( taskPREEMPTS_CURRENT_TASK( pxTCB ) )
 					{
 						/* Pend the yield to be performed when the scheduler
 						is unsuspended. */
@@ -2925,7 +3111,7 @@ BaseType_t xReturn;
 		vListInsertEnd( &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
 	}
 
-	if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+	if( taskPREEMPTS_CURRENT_TASK( pxUnblockedTCB ) )
 	{
 		/* Return true if the task removed from the event list has a higher
 		priority than the calling task.  This allows the calling task to know if
@@ -2983,7 +3169,7 @@ BaseType_t xReturn;
 	( void ) uxListRemove( &( pxUnblockedTCB->xStateListItem ) );
 	prvAddTaskToReadyList( pxUnblockedTCB );
 
-	if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+	if( taskPREEMPTS_CURRENT_TASK( pxUnblockedTCB ) )
 	{
 		/* Return true if the task removed from the event list has
 		a higher priority than the calling task.  This allows
@@ -4420,7 +4606,7 @@ TickType_t uxReturn;
 				}
 				#endif
 
-				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				if( taskPREEMPTS_CURRENT_TASK( pxTCB ) )
 				{
 					/* The notified task has a priority above the currently
 					executing task so a yield is required. */
@@ -4538,7 +4724,7 @@ TickType_t uxReturn;
 					vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
 				}
 
-				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				if( taskPREEMPTS_CURRENT_TASK( pxTCB ) )
 				{
 					/* The notified task has a priority above the currently
 					executing task so a yield is required. */
@@ -4628,7 +4814,7 @@ TickType_t uxReturn;
 					vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
 				}
 
-				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				if( taskPREEMPTS_CURRENT_TASK( pxTCB ) )
 				{
 					/* The notified task has a priority above the currently
 					executing task so a yield is required. */
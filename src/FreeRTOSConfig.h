@@ -90,7 +90,7 @@ extern uint32_t SystemCoreClock;
 #define configUSE_TICK_HOOK				0
 #define configCPU_CLOCK_HZ				( SystemCoreClock )
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
-#define configMAX_PRIORITIES			( 6 )
+#define configMAX_PRIORITIES			( 7 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 130 )
 #define configTOTAL_HEAP_SIZE			( ( size_t ) ( 28 * 1024 ) )
 #define configMAX_TASK_NAME_LEN			( 10 )
@@ -104,15 +104,39 @@ extern uint32_t SystemCoreClock;
 #define configUSE_MALLOC_FAILED_HOOK	1
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configUSE_COUNTING_SEMAPHORES	1
+#define configUSE_QUEUE_SETS			1
+
+/* Set configUSE_EDF_SCHEDULING to 1 to have the kernel order the ready tasks
+of priority configEDF_PRIORITY by absolute deadline (see vTaskSetDeadline()).
+The DD scheduler then runs its workers in that band instead of switching their
+priorities.  configEDF_PRIORITY must match USER_ACTIVE_TASK_PRIORITY in main.c.
+It can also be set from the compiler command line, as make sim_edf does. */
+#ifndef configUSE_EDF_SCHEDULING
+	#define configUSE_EDF_SCHEDULING	0
+#endif
+#define configEDF_PRIORITY				( 2 )
 #define configGENERATE_RUN_TIME_STATS	0
 
+/* Set configUSE_CYCLE_STATS to 1 to count the cycles taken by the DD scheduler
+operations and by the context switches with the DWT cycle counter, see
+cycle_stats.h.  Nothing is compiled in when it is 0. */
+#ifndef configUSE_CYCLE_STATS
+	#define configUSE_CYCLE_STATS		0
+#endif
+#if ( configUSE_CYCLE_STATS == 1 )
+	void cycle_stats_switched_out( void );
+	void cycle_stats_switched_in( void );
+	#define traceTASK_SWITCHED_OUT()	cycle_stats_switched_out()
+	#define traceTASK_SWITCHED_IN()		cycle_stats_switched_in()
+#endif
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 
 /* Software timer definitions. */
 #define configUSE_TIMERS				1
-#define configTIMER_TASK_PRIORITY		( 4 )
+#define configTIMER_TASK_PRIORITY		( 5 )
 #define configTIMER_QUEUE_LENGTH		5
 #define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
 
@@ -125,6 +149,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
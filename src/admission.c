@@ -0,0 +1,343 @@
+/**
+ * @file admission.c
+ * @brief Online admission control for the EDF scheduler. Registered periodic
+ *    tasks are kept in a table together with their running utilization. A new
+ *    periodic task is admitted if the utilization stays at or below 100% and,
+ *    when some deadlines are shorter than periods, the processor demand
+ *    function stays below the available time at every deadline up to the
+ *    usual bound. Aperiodic jobs are admitted if the periodic demand plus the
+ *    admitted aperiodic demand fits before their deadline and before the
+ *    deadline of every aperiodic job already admitted. Bandwidth can also be
+ *    reserved for an aperiodic server, it then counts as an implicit deadline
+ *    task of that utilization in every periodic test. A task that runs above
+ *    the EDF band with a bounded budget, such as the log task, is reserved
+ *    the same way. It takes at most its bandwidth times t plus one budget
+ *    from any window t, so the reservation holds for deadlines much longer
+ *    than its period.
+ *
+ *    Periodic demand in a window is bounded with the demand bound function of
+ *    the task set. Jobs released before the window starts are not counted, so
+ *    the aperiodic test is an estimate rather than an exact guarantee.
+ *
+ *    Calls must not overlap. release_dd_task() masks the release engine
+ *    interrupt around the job tests.
+ */
+
+#include "admission.h"
+
+#define PPM 1000000ULL
+
+/**
+ * @brief Admitted periodic task
+ *
+ * @param user_task_id (uint32_t) The user task id
+ * @param period (uint32_t) Period in ticks
+ * @param execution_time (uint32_t) Worst case execution time in ticks
+ * @param relative_deadline (uint32_t) Relative deadline in ticks
+ */
+typedef struct admission_task {
+    uint32_t user_task_id;
+    uint32_t period;
+    uint32_t execution_time;
+    uint32_t relative_deadline;
+} admission_task_t;
+
+/**
+ * @brief Admitted aperiodic job whose deadline has not passed
+ *
+ * @param absolute_deadline (uint32_t) Absolute deadline in ticks
+ * @param execution_time (uint32_t) Worst case execution time in ticks
+ */
+typedef struct admission_job {
+    uint32_t absolute_deadline;
+    uint32_t execution_time;
+} admission_job_t;
+
+static admission_task_t periodic_tasks[ADMISSION_MAX_PERIODIC_TASKS];
+static uint32_t periodic_task_count = 0;
+static admission_job_t aperiodic_jobs[ADMISSION_MAX_APERIODIC_JOBS];
+static uint32_t aperiodic_job_count = 0;
+static admission_stats_t admission_stats = { 0, 0, 0, 0, 0, 0, 0 };
+
+/**
+ * @brief Utilization of a task in parts per million, rounded up
+ *
+ * @param task (admission_task_t *) [IN] The task
+ * @return (uint64_t) C/T in ppm
+ */
+static uint64_t task_utilization(const admission_task_t *task) {
+    return ((uint64_t)task->execution_time * PPM + task->period - 1) / task->period;
+}
+
+/**
+ * @brief Bandwidth reserved next to the periodic tasks, for the aperiodic
+ *        server and for the tasks outside EDF
+ *
+ * @return (uint64_t) Bandwidth in ppm
+ */
+static uint64_t reserved_bandwidth(void) {
+    return (uint64_t)admission_stats.server_utilization_ppm + admission_stats.reserved_ppm;
+}
+
+/**
+ * @brief Processor demand of the periodic tasks in any window of length t:
+ *        the execution time of every job that can be both released and due
+ *        within the window.
+ *
+ * @param tasks (admission_task_t *) [IN] The tasks
+ * @param count (uint32_t) [IN] Number of tasks
+ * @param t (uint32_t) [IN] Window length in ticks
+ * @return (uint64_t) Demand in ticks
+ */
+static uint64_t demand_bound(const admission_task_t *tasks, uint32_t count, uint32_t t) {
+    uint64_t demand = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (t >= tasks[i].relative_deadline) {
+            demand += ((uint64_t)(t - tasks[i].relative_deadline) / tasks[i].period + 1) * tasks[i].execution_time;
+        }
+    }
+    return demand;
+}
+
+/**
+ * @brief Processor demand test for constrained deadline task sets. Checks
+ *        dbf(t) + U_s * t <= t at every absolute deadline t up to the bound
+ *        L = max(D_max, sum((T_i - D_i) * U_i) / (1 - U)), U_s being the
+ *        bandwidth reserved for the aperiodic server.
+ *
+ * @param tasks (admission_task_t *) [IN] The tasks
+ * @param count (uint32_t) [IN] Number of tasks
+ * @param utilization_ppm (uint64_t) [IN] Total utilization of the tasks and the server in ppm
+ * @param server_ppm (uint64_t) [IN] Bandwidth reserved for the server and the tasks outside EDF, in ppm
+ * @return (bool) true if every deadline is met
+ */
+static bool demand_test(const admission_task_t *tasks, uint32_t count, uint64_t utilization_ppm,
+    uint64_t server_ppm) {
+    uint64_t limit = 0;
+    uint64_t slack_ppm = 0;
+    bool constrained = false;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (tasks[i].relative_deadline < tasks[i].period) {
+            constrained = true;
+            slack_ppm += (uint64_t)(tasks[i].period - tasks[i].relative_deadline) * task_utilization(&tasks[i]);
+        }
+        if (tasks[i].relative_deadline > limit) {
+            limit = tasks[i].relative_deadline;
+        }
+    }
+    if (!constrained) {
+        // Implicit deadlines: U <= 1 is necessary and sufficient
+        return true;
+    }
+    if (utilization_ppm >= PPM) {
+        // Full utilization with constrained deadlines, only the hyperperiod
+        // would bound the test, which is not worth running on target
+        return false;
+    }
+    uint64_t busy = slack_ppm / (PPM - utilization_ppm) + 1;
+    if (busy > limit) {
+        limit = busy;
+    }
+    if (limit > ADMISSION_MAX_TEST_INTERVAL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint64_t t = tasks[i].relative_deadline; t <= limit; t += tasks[i].period) {
+            if (demand_bound(tasks, count, (uint32_t)t) + (t * server_ppm + PPM - 1) / PPM > t) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Count an admission result
+ *
+ * @param result (admission_result_t) [IN] The result
+ * @return (admission_result_t) result
+ */
+static admission_result_t record(admission_result_t result) {
+    if (result == ADMISSION_ACCEPTED) {
+        admission_stats.accepted++;
+    } else {
+        admission_stats.rejected++;
+    }
+    return result;
+}
+
+/**
+ * @brief Register a periodic task if the task set stays schedulable under EDF
+ *
+ * @param user_task_id (uint32_t) [IN] The user task id
+ * @param period (uint32_t) [IN] Period in ticks, must not be 0
+ * @param execution_time (uint32_t) [IN] Worst case execution time in ticks
+ * @param relative_deadline (uint32_t) [IN] Relative deadline in ticks, 0 for the period
+ * @return (admission_result_t) ADMISSION_ACCEPTED if the task was registered
+ */
+admission_result_t admit_periodic_task(uint32_t user_task_id, uint32_t period,
+    uint32_t execution_time, uint32_t relative_deadline) {
+    if (period == 0 || periodic_task_count >= ADMISSION_MAX_PERIODIC_TASKS) {
+        return record(ADMISSION_REJECTED_FULL);
+    }
+    admission_task_t *candidate = &periodic_tasks[periodic_task_count];
+    candidate->user_task_id = user_task_id;
+    candidate->period = period;
+    candidate->execution_time = execution_time;
+    candidate->relative_deadline = relative_deadline == 0 ? period : relative_deadline;
+
+    uint64_t utilization_ppm = admission_stats.utilization_ppm + task_utilization(candidate);
+    uint64_t server_ppm = reserved_bandwidth();
+    if (utilization_ppm + server_ppm > PPM) {
+        return record(ADMISSION_REJECTED_UTILIZATION);
+    }
+    if (!demand_test(periodic_tasks, periodic_task_count + 1, utilization_ppm + server_ppm, server_ppm)) {
+        return record(ADMISSION_REJECTED_DEMAND);
+    }
+    periodic_task_count++;
+    admission_stats.periodic_tasks = periodic_task_count;
+    admission_stats.utilization_ppm = (uint32_t)utilization_ppm;
+    return record(ADMISSION_ACCEPTED);
+}
+
+/**
+ * @brief Test whether more bandwidth can be reserved next to the periodic
+ *        tasks and what is already reserved
+ *
+ * @param bandwidth_ppm (uint32_t) [IN] Bandwidth to add, in ppm
+ * @return (admission_result_t) ADMISSION_ACCEPTED if it fits, not counted
+ */
+static admission_result_t test_reservation(uint32_t bandwidth_ppm) {
+    uint64_t server_ppm = reserved_bandwidth() + bandwidth_ppm;
+    uint64_t utilization_ppm = admission_stats.utilization_ppm + server_ppm;
+    if (utilization_ppm > PPM) {
+        return ADMISSION_REJECTED_UTILIZATION;
+    }
+    if (!demand_test(periodic_tasks, periodic_task_count, utilization_ppm, server_ppm)) {
+        return ADMISSION_REJECTED_DEMAND;
+    }
+    return ADMISSION_ACCEPTED;
+}
+
+/**
+ * @brief Reserve bandwidth for an aperiodic server if the periodic tasks stay
+ *        schedulable next to it. The jobs the server hands deadlines to need
+ *        no test of their own.
+ *
+ * @param bandwidth_ppm (uint32_t) [IN] Server bandwidth in ppm
+ * @return (admission_result_t) ADMISSION_ACCEPTED if the bandwidth was reserved
+ */
+admission_result_t admit_server(uint32_t bandwidth_ppm) {
+    admission_result_t result = test_reservation(bandwidth_ppm);
+    if (result == ADMISSION_ACCEPTED) {
+        admission_stats.server_utilization_ppm += bandwidth_ppm;
+    }
+    return record(result);
+}
+
+/**
+ * @brief Reserve bandwidth for a task that runs above the EDF band with a
+ *        bounded budget, if the periodic tasks stay schedulable next to it.
+ *        Reserve it before admitting the periodic tasks.
+ *
+ * @param bandwidth_ppm (uint32_t) [IN] Budget over period of the task, in ppm
+ * @return (admission_result_t) ADMISSION_ACCEPTED if the bandwidth was reserved
+ */
+admission_result_t admit_reservation(uint32_t bandwidth_ppm) {
+    admission_result_t result = test_reservation(bandwidth_ppm);
+    if (result == ADMISSION_ACCEPTED) {
+        admission_stats.reserved_ppm += bandwidth_ppm;
+    }
+    return record(result);
+}
+
+/**
+ * @brief Check a job of a periodic task. Jobs of admitted tasks are always
+ *        accepted since the whole task was tested on registration.
+ *
+ * @param user_task_id (uint32_t) [IN] The user task id of the job
+ * @return (admission_result_t) ADMISSION_ACCEPTED if the task was admitted
+ */
+admission_result_t admit_periodic_job(uint32_t user_task_id) {
+    for (uint32_t i = 0; i < periodic_task_count; i++) {
+        if (periodic_tasks[i].user_task_id == user_task_id) {
+            return record(ADMISSION_ACCEPTED);
+        }
+    }
+    return record(ADMISSION_REJECTED_UNKNOWN);
+}
+
+/**
+ * @brief Admit an aperiodic job if its demand, the demand of the periodic
+ *        tasks and of the server, and the demand of already admitted
+ *        aperiodic jobs fit before its deadline and before the later
+ *        deadlines of admitted jobs.
+ *
+ * @param now (uint32_t) [IN] Current time in ticks
+ * @param absolute_deadline (uint32_t) [IN] Absolute deadline of the job in ticks
+ * @param execution_time (uint32_t) [IN] Worst case execution time in ticks
+ * @return (admission_result_t) ADMISSION_ACCEPTED if the job was admitted
+ */
+admission_result_t admit_aperiodic_job(uint32_t now, uint32_t absolute_deadline,
+    uint32_t execution_time) {
+    // Forget jobs whose deadline has passed. Ticks wrap, so deadlines are
+    // compared by difference.
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < aperiodic_job_count; i++) {
+        if ((int32_t)(aperiodic_jobs[i].absolute_deadline - now) > 0) {
+            aperiodic_jobs[kept++] = aperiodic_jobs[i];
+        }
+    }
+    aperiodic_job_count = kept;
+
+    if ((int32_t)(absolute_deadline - now) <= 0) {
+        return record(ADMISSION_REJECTED_DEMAND);
+    }
+    if (aperiodic_job_count >= ADMISSION_MAX_APERIODIC_JOBS) {
+        return record(ADMISSION_REJECTED_FULL);
+    }
+    aperiodic_jobs[aperiodic_job_count].absolute_deadline = absolute_deadline;
+    aperiodic_jobs[aperiodic_job_count].execution_time = execution_time;
+
+    // Check the new deadline and every admitted deadline after it
+    for (uint32_t i = 0; i <= aperiodic_job_count; i++) {
+        uint32_t deadline = aperiodic_jobs[i].absolute_deadline;
+        if ((int32_t)(deadline - absolute_deadline) < 0) {
+            continue;
+        }
+        uint64_t demand = demand_bound(periodic_tasks, periodic_task_count, deadline - now)
+            + ((uint64_t)(deadline - now) * reserved_bandwidth() + PPM - 1) / PPM;
+        for (uint32_t j = 0; j <= aperiodic_job_count; j++) {
+            if ((int32_t)(aperiodic_jobs[j].absolute_deadline - deadline) <= 0) {
+                demand += aperiodic_jobs[j].execution_time;
+            }
+        }
+        if (demand > deadline - now) {
+            return record(ADMISSION_REJECTED_DEMAND);
+        }
+    }
+    aperiodic_job_count++;
+    return record(ADMISSION_ACCEPTED);
+}
+
+/**
+ * @brief Count a released job that the DDS dropped, no worker or active slot
+ *        was free. Only a counter, so the DDS may call it while a release is
+ *        being tested.
+ *
+ * @return (void)
+ */
+void admission_record_drop(void) {
+    admission_stats.dropped++;
+}
+
+/**
+ * @brief Copy the admission control counters
+ *
+ * @param stats (admission_stats_t *) [OUT] Where to copy the counters
+ * @return (void)
+ */
+void get_admission_stats(admission_stats_t *stats) {
+    *stats = admission_stats;
+}
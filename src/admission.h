@@ -0,0 +1,81 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Maximum number of periodic tasks that can be registered
+ */
+#ifndef ADMISSION_MAX_PERIODIC_TASKS
+#define ADMISSION_MAX_PERIODIC_TASKS 64
+#endif
+
+/**
+ * @brief Maximum number of admitted aperiodic jobs whose deadline has not
+ *        passed yet
+ */
+#ifndef ADMISSION_MAX_APERIODIC_JOBS
+#define ADMISSION_MAX_APERIODIC_JOBS 16
+#endif
+
+/**
+ * @brief Longest interval, in ticks, over which the processor demand test is
+ *        run. A task set that needs a longer interval is rejected.
+ */
+#ifndef ADMISSION_MAX_TEST_INTERVAL
+#define ADMISSION_MAX_TEST_INTERVAL 100000
+#endif
+
+/**
+ * @brief Result of an admission test
+ * 
+ * @param ADMISSION_ACCEPTED The task or job keeps the set schedulable
+ * @param ADMISSION_REJECTED_UTILIZATION Total utilization would exceed 100%
+ * @param ADMISSION_REJECTED_DEMAND Processor demand would exceed the time available before a deadline
+ * @param ADMISSION_REJECTED_FULL No room left to register the task or job
+ * @param ADMISSION_REJECTED_UNKNOWN Periodic job of a task that was never admitted
+ */
+typedef enum admission_result {
+    ADMISSION_ACCEPTED,
+    ADMISSION_REJECTED_UTILIZATION,
+    ADMISSION_REJECTED_DEMAND,
+    ADMISSION_REJECTED_FULL,
+    ADMISSION_REJECTED_UNKNOWN
+} admission_result_t;
+
+/**
+ * @brief Admission control counters
+ * 
+ * @param utilization_ppm (uint32_t) Utilization of the admitted periodic tasks in parts per million
+ * @param server_utilization_ppm (uint32_t) Bandwidth reserved for the aperiodic server in parts per million
+ * @param reserved_ppm (uint32_t) Bandwidth reserved for tasks outside EDF, such as the log task, in parts per million
+ * @param periodic_tasks (uint32_t) Number of admitted periodic tasks
+ * @param accepted (uint32_t) Number of accepted tasks and jobs
+ * @param rejected (uint32_t) Number of rejected tasks and jobs
+ * @param dropped (uint32_t) Number of released jobs the DDS dropped afterwards
+ */
+typedef struct admission_stats {
+    uint32_t utilization_ppm;
+    uint32_t server_utilization_ppm;
+    uint32_t reserved_ppm;
+    uint32_t periodic_tasks;
+    uint32_t accepted;
+    uint32_t rejected;
+    uint32_t dropped;
+} admission_stats_t;
+
+
+admission_result_t admit_periodic_task(uint32_t user_task_id, uint32_t period,
+    uint32_t execution_time, uint32_t relative_deadline);
+admission_result_t admit_server(uint32_t bandwidth_ppm);
+admission_result_t admit_reservation(uint32_t bandwidth_ppm);
+admission_result_t admit_periodic_job(uint32_t user_task_id);
+admission_result_t admit_aperiodic_job(uint32_t now, uint32_t absolute_deadline,
+    uint32_t execution_time);
+void admission_record_drop(void);
+void get_admission_stats(admission_stats_t *stats);
+
+
+#endif
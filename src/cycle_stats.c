@@ -0,0 +1,169 @@
+/**
+ * @file cycle_stats.c
+ * @brief Cycle counts of the DD scheduler operations and of the context
+ *    switches, from the Cortex-M4 DWT cycle counter. Each measurement
+ *    updates the min, max, sum and a power of two histogram of its
+ *    operation, so the cost of the instrumentation is a few loads and stores
+ *    and does not depend on how long the system ran. Only built in with
+ *    configUSE_CYCLE_STATS set to 1.
+ *
+ *    The simulated host build has no DWT, it counts nanoseconds of the host
+ *    clock instead.
+ */
+
+#include "stm32f4xx.h"
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "cycle_stats.h"
+
+#if ( configUSE_CYCLE_STATS == 1 )
+
+#ifdef DD_SIM_BUILD
+#include <time.h>
+#else
+#include "dwt.h"
+#endif
+
+/**
+ * @brief Counters of an operation
+ *
+ * @param total (uint64_t) Sum of the measurements, for the mean
+ * @param stats (cycle_stats_t) Everything else, mean left at 0
+ */
+typedef struct cycle_stats_entry {
+    uint64_t total;
+    cycle_stats_t stats;
+} cycle_stats_entry_t;
+
+static cycle_stats_entry_t cycle_stats_entries[CYCLE_OP_COUNT];
+static uint32_t switched_out_cycles = 0;
+
+static const char *cycle_stats_names[CYCLE_OP_COUNT] = {
+    "heap_push",
+    "heap_remove",
+    "history_push",
+    "update_priorities",
+    "deadline_timer",
+    "overdue",
+    "completion_send",
+    "snapshot",
+    "monitor_create",
+    "context_switch"
+};
+
+/**
+ * @brief Start the DWT cycle counter and clear the counters. Called before
+ *        the scheduler starts.
+ *
+ * @return (void)
+ */
+void init_cycle_stats(void) {
+#ifndef DD_SIM_BUILD
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+    for (uint32_t op = 0; op < CYCLE_OP_COUNT; op++) {
+        cycle_stats_entries[op].total = 0;
+        cycle_stats_entries[op].stats.count = 0;
+        cycle_stats_entries[op].stats.min = 0;
+        cycle_stats_entries[op].stats.max = 0;
+        cycle_stats_entries[op].stats.mean = 0;
+        for (uint32_t bucket = 0; bucket < CYCLE_STATS_BUCKETS; bucket++) {
+            cycle_stats_entries[op].stats.histogram[bucket] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Current value of the cycle counter
+ *
+ * @return (uint32_t) Cycles, wraps around every 25 s at 168 MHz
+ */
+uint32_t cycle_stats_now(void) {
+#ifdef DD_SIM_BUILD
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#else
+    return DWT_CYCCNT;
+#endif
+}
+
+/**
+ * @brief Add a measurement. Safe from a task, an ISR or the context switch.
+ *
+ * @param op (cycle_stats_op_t) [IN] The operation measured
+ * @param cycles (uint32_t) [IN] Cycles it took
+ * @return (void)
+ */
+void cycle_stats_record(cycle_stats_op_t op, uint32_t cycles) {
+    uint32_t bucket = 0;
+    while (bucket < CYCLE_STATS_BUCKETS - 1 && (cycles >> (bucket + 1)) != 0) {
+        bucket++;
+    }
+
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    cycle_stats_entry_t *entry = &cycle_stats_entries[op];
+    if (entry->stats.count == 0 || cycles < entry->stats.min) {
+        entry->stats.min = cycles;
+    }
+    if (cycles > entry->stats.max) {
+        entry->stats.max = cycles;
+    }
+    entry->stats.count++;
+    entry->total += cycles;
+    entry->stats.histogram[bucket]++;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/**
+ * @brief Copy the counters of an operation
+ *
+ * @param op (cycle_stats_op_t) [IN] The operation
+ * @param stats (cycle_stats_t *) [OUT] Where to copy the counters
+ * @return (bool) false if op is not an operation
+ */
+bool get_cycle_stats(cycle_stats_op_t op, cycle_stats_t *stats) {
+    if (op >= CYCLE_OP_COUNT) {
+        return false;
+    }
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *stats = cycle_stats_entries[op].stats;
+    if (stats->count > 0) {
+        stats->mean = (uint32_t)(cycle_stats_entries[op].total / stats->count);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return true;
+}
+
+/**
+ * @brief Name of an operation, for the monitor
+ *
+ * @param op (cycle_stats_op_t) [IN] The operation
+ * @return (const char *) The name
+ */
+const char *get_cycle_stats_name(cycle_stats_op_t op) {
+    return op < CYCLE_OP_COUNT ? cycle_stats_names[op] : "?";
+}
+
+/**
+ * @brief traceTASK_SWITCHED_OUT, the kernel is about to pick the next task
+ *
+ * @return (void)
+ */
+void cycle_stats_switched_out(void) {
+    switched_out_cycles = cycle_stats_now();
+}
+
+/**
+ * @brief traceTASK_SWITCHED_IN, the kernel picked the next task
+ *
+ * @return (void)
+ */
+void cycle_stats_switched_in(void) {
+    cycle_stats_record(CYCLE_OP_CONTEXT_SWITCH, cycle_stats_now() - switched_out_cycles);
+}
+
+#endif
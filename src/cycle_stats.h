@@ -0,0 +1,86 @@
+#ifndef CYCLE_STATS_H
+#define CYCLE_STATS_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+
+/**
+ * @brief Number of histogram buckets. Bucket i counts the measurements of
+ *        2^i to 2^(i+1) - 1 cycles, the last one everything above.
+ */
+#define CYCLE_STATS_BUCKETS 20
+
+/**
+ * @brief Operation measured. configUSE_CYCLE_STATS in FreeRTOSConfig.h turns
+ *        the measurements on.
+ *
+ * @param CYCLE_OP_HEAP_PUSH Insert a released job in the active heap
+ * @param CYCLE_OP_HEAP_REMOVE Remove a completed job from the active heap
+ * @param CYCLE_OP_HISTORY_PUSH Add a job to the completed or overdue list
+ * @param CYCLE_OP_UPDATE_PRIORITIES Follow the earliest deadline with the worker priorities
+ * @param CYCLE_OP_DEADLINE_TIMER Re-arm the deadline timer
+ * @param CYCLE_OP_OVERDUE Move the overdue jobs to the overdue list
+ * @param CYCLE_OP_COMPLETION_SEND Queue a completion to the DDS, from a worker. The DDS
+ *        has the higher priority, so this includes the DDS handling the completion.
+ * @param CYCLE_OP_SNAPSHOT Publish the active tasks to the snapshot the monitor reads
+ * @param CYCLE_OP_MONITOR_CREATE Create the monitor task
+ * @param CYCLE_OP_CONTEXT_SWITCH Pick the next task, from traceTASK_SWITCHED_OUT to traceTASK_SWITCHED_IN
+ * @param CYCLE_OP_COUNT Number of operations
+ */
+typedef enum cycle_stats_op {
+    CYCLE_OP_HEAP_PUSH,
+    CYCLE_OP_HEAP_REMOVE,
+    CYCLE_OP_HISTORY_PUSH,
+    CYCLE_OP_UPDATE_PRIORITIES,
+    CYCLE_OP_DEADLINE_TIMER,
+    CYCLE_OP_OVERDUE,
+    CYCLE_OP_COMPLETION_SEND,
+    CYCLE_OP_SNAPSHOT,
+    CYCLE_OP_MONITOR_CREATE,
+    CYCLE_OP_CONTEXT_SWITCH,
+    CYCLE_OP_COUNT
+} cycle_stats_op_t;
+
+/**
+ * @brief Cycle counts of an operation
+ *
+ * @param count (uint32_t) Number of measurements
+ * @param min (uint32_t) Fewest cycles
+ * @param max (uint32_t) Most cycles
+ * @param mean (uint32_t) Mean number of cycles
+ * @param histogram (uint32_t[]) Measurements per power of two bucket
+ */
+typedef struct cycle_stats {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+    uint32_t histogram[CYCLE_STATS_BUCKETS];
+} cycle_stats_t;
+
+
+#if ( configUSE_CYCLE_STATS == 1 )
+
+void init_cycle_stats(void);
+uint32_t cycle_stats_now(void);
+void cycle_stats_record(cycle_stats_op_t op, uint32_t cycles);
+bool get_cycle_stats(cycle_stats_op_t op, cycle_stats_t *stats);
+const char *get_cycle_stats_name(cycle_stats_op_t op);
+
+/* Bracket an operation, start is a uint32_t local. */
+#define cycle_stats_begin(start) ((start) = cycle_stats_now())
+#define cycle_stats_end(op, start) cycle_stats_record((op), cycle_stats_now() - (start))
+
+#else
+
+#define init_cycle_stats() ((void)0)
+#define cycle_stats_begin(start) ((start) = 0)
+#define cycle_stats_end(op, start) ((void)(start))
+
+#endif
+
+
+#endif
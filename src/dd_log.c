@@ -0,0 +1,248 @@
+/**
+ * @file dd_log.c
+ * @brief Deferred logging. dd_log() stores the format pointer and the raw
+ *    arguments in a ring of fixed size records, and the log task formats
+ *    and prints them later with dd_log_drain(). Logging
+ *    therefore costs a few stores, never formats, never waits for the ITM
+ *    and never masks interrupts.
+ *
+ *    Any task or ISR can log. A producer reserves a slot by advancing head
+ *    with a compare and swap (ldrex/strex on the Cortex-M4), fills it, then
+ *    publishes it by writing its sequence. The single consumer only writes
+ *    tail, and stops at the first reserved slot not published yet.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dd_log.h"
+
+#define DD_LOG_MASK (DD_LOG_SIZE - 1)
+
+/* Keep slot accesses on the right side of the sequence and tail updates,
+also emits a dmb on the Cortex-M4. */
+#define dd_log_barrier() __sync_synchronize()
+
+static dd_log_record_t dd_log_records[DD_LOG_SIZE];
+static volatile uint32_t dd_log_head = 0;
+static volatile uint32_t dd_log_tail = 0;
+static volatile uint32_t dd_log_dropped = 0;
+static volatile uint32_t dd_log_high_water_mark = 0;
+
+/**
+ * @brief Initialize the log ring, empty. Called before any record.
+ *
+ * @return (void)
+ */
+void init_dd_log(void) {
+    dd_log_head = 0;
+    dd_log_tail = 0;
+    dd_log_dropped = 0;
+    dd_log_high_water_mark = 0;
+    for (uint32_t i = 0; i < DD_LOG_SIZE; i++) {
+        dd_log_records[i].sequence = 0;
+    }
+}
+
+/**
+ * @brief Find the next conversion of a format, skipping %% and the flags
+ *        and width tiny_printf knows ('-', '0' and digits)
+ *
+ * @param fmt (const char *) [IN] Where to start looking
+ * @param start (const char **) [OUT] The '%' of the conversion found
+ * @return (const char *) Its conversion character, NULL if there is none left
+ */
+static const char *dd_log_next_conversion(const char *fmt, const char **start) {
+    for (; *fmt != '\0'; fmt++) {
+        if (*fmt != '%') {
+            continue;
+        }
+        if (fmt[1] == '%') {
+            fmt++;
+            continue;
+        }
+        const char *conversion = fmt + 1;
+        while (*conversion == '-' || (*conversion >= '0' && *conversion <= '9')) {
+            conversion++;
+        }
+        if (*conversion == '\0') {
+            return NULL;
+        }
+        *start = fmt;
+        return conversion;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Log a record, printed later by dd_log_drain(). Safe from a task or
+ *        an ISR. Each argument is read with the type its conversion
+ *        promotes to: const char * for %s, int for %d, %i and %c, unsigned
+ *        otherwise, as for the conversions of tiny_printf.
+ *
+ * @param fmt (const char *) [IN] printf format, kept by pointer
+ * @param ... The arguments, kept by value
+ * @return (bool) false if the ring was full and the record was dropped
+ */
+bool dd_log(const char *fmt, ...) {
+    uint32_t head = dd_log_head;
+    uint32_t pending;
+    do {
+        pending = head - dd_log_tail;
+        if (pending >= DD_LOG_SIZE) {
+            __atomic_fetch_add(&dd_log_dropped, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&dd_log_head, &head, head + 1, true,
+        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    dd_log_record_t *record = &dd_log_records[head & DD_LOG_MASK];
+    const char *scan = fmt;
+    const char *start;
+    const char *conversion;
+    uint32_t count = 0;
+    va_list va;
+    va_start(va, fmt);
+    while (count < DD_LOG_MAX_ARGS && (conversion = dd_log_next_conversion(scan, &start)) != NULL) {
+        switch (*conversion) {
+        case 's':
+            record->args[count++] = (uintptr_t)va_arg(va, const char *);
+            break;
+        case 'd':
+        case 'i':
+        case 'c':
+            record->args[count++] = (uintptr_t)(unsigned)va_arg(va, int);
+            break;
+        default:
+            record->args[count++] = va_arg(va, unsigned);
+            break;
+        }
+        scan = conversion + 1;
+    }
+    va_end(va);
+    while (count < DD_LOG_MAX_ARGS) {
+        record->args[count++] = 0;
+    }
+    record->fmt = fmt;
+    dd_log_barrier();
+    record->sequence = head + 1;
+
+    // Only a statistic, a lost update under contention is fine
+    if (pending + 1 > dd_log_high_water_mark) {
+        dd_log_high_water_mark = pending + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Format a record into a line, one conversion at a time so each
+ *        argument is passed back with the type dd_log() read it with
+ *
+ * @param record (const dd_log_record_t *) [IN] The record
+ * @param line (char *) [OUT] Where to format, cut at DD_LOG_LINE_SIZE
+ * @return (void)
+ */
+static void dd_log_format(const dd_log_record_t *record, char *line) {
+    const char *fmt = record->fmt;
+    const char *start;
+    const char *conversion;
+    uint32_t length = 0;
+    uint32_t arg = 0;
+    line[0] = '\0';
+    while ((conversion = dd_log_next_conversion(fmt, &start)) != NULL || *fmt != '\0') {
+        // The text before the conversion, or the rest of the format
+        const char *end = conversion != NULL ? start : fmt + strlen(fmt);
+        for (; fmt < end && length < DD_LOG_LINE_SIZE - 1; fmt++) {
+            line[length++] = *fmt;
+            if (fmt[0] == '%' && fmt[1] == '%') {
+                fmt++;
+            }
+        }
+        line[length] = '\0';
+        if (conversion == NULL || length >= DD_LOG_LINE_SIZE - 1) {
+            break;
+        }
+
+        // A single conversion format, flags and width kept
+        char spec[8];
+        uint32_t spec_length = (uint32_t)(conversion - start) + 1;
+        if (spec_length >= sizeof(spec)) {
+            spec[0] = '%';
+            spec_length = 1;
+        } else {
+            memcpy(spec, start, spec_length - 1);
+            spec_length--;
+        }
+        spec[spec_length++] = *conversion;
+        spec[spec_length] = '\0';
+
+        uintptr_t value = arg < DD_LOG_MAX_ARGS ? record->args[arg++] : 0;
+        char *out = &line[length];
+        uint32_t room = DD_LOG_LINE_SIZE - length;
+        switch (*conversion) {
+        case 's':
+            snprintf(out, room, spec, value != 0 ? (const char *)value : "(null)");
+            break;
+        case 'd':
+        case 'i':
+        case 'c':
+            snprintf(out, room, spec, (int)(unsigned)value);
+            break;
+        default:
+            snprintf(out, room, spec, (unsigned)value);
+            break;
+        }
+        length += strlen(out);
+        fmt = conversion + 1;
+    }
+}
+
+/**
+ * @brief Format and print the records published so far, oldest first.
+ *        Consumer side only, called by the logging task.
+ *
+ * @param max_records (uint32_t) [IN] Most records to print
+ * @return (uint32_t) Number of records printed
+ */
+uint32_t dd_log_drain(uint32_t max_records) {
+    static char line[DD_LOG_LINE_SIZE];
+    uint32_t printed = 0;
+    uint32_t tail = dd_log_tail;
+    while (printed < max_records) {
+        dd_log_record_t *record = &dd_log_records[tail & DD_LOG_MASK];
+        if (record->sequence != tail + 1) {
+            break;
+        }
+        dd_log_barrier();
+        dd_log_record_t copy = *record;
+        dd_log_barrier();
+        // Free the slot before printing, producers need not wait for the ITM
+        dd_log_tail = ++tail;
+        dd_log_format(&copy, line);
+        printf("%s", line);
+        printed++;
+    }
+    return printed;
+}
+/**
+ * @brief Number of records reserved and not printed yet, 0 once everything
+ *        logged so far has been handed to the console
+ *
+ * @return (uint32_t) Records waiting for the drain
+ */
+uint32_t dd_log_pending(void) {
+    return dd_log_head - dd_log_tail;
+}
+
+/**
+ * @brief Copy the log ring counters
+ *
+ * @param stats (dd_log_stats_t *) [OUT] Where to copy the counters
+ * @return (void)
+ */
+void get_dd_log_stats(dd_log_stats_t *stats) {
+    stats->logged = dd_log_head;
+    stats->dropped = dd_log_dropped;
+    stats->high_water_mark = dd_log_high_water_mark;
+}
@@ -0,0 +1,68 @@
+#ifndef DD_LOG_H
+#define DD_LOG_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of records the log ring holds, must be a power of two. A
+ *        record logged while the ring is full is dropped and counted.
+ */
+#ifndef DD_LOG_SIZE
+#define DD_LOG_SIZE 256
+#endif
+
+#if (DD_LOG_SIZE & (DD_LOG_SIZE - 1)) != 0
+#error "DD_LOG_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Most conversions a dd_log() format may have, the rest are printed
+ *        as 0
+ */
+#define DD_LOG_MAX_ARGS 8
+
+/**
+ * @brief Longest line a record prints, including the terminator, the rest
+ *        is cut
+ */
+#define DD_LOG_LINE_SIZE 160
+
+/**
+ * @brief Log record, formatted by the drain task and not by the caller
+ *
+ * @param sequence (uint32_t) Record number plus one once the record is
+ *        written, tells the drain a reserved slot is ready
+ * @param fmt (const char *) printf format, must outlive the record (a literal)
+ * @param args (uintptr_t[]) The arguments, as read for their conversion,
+ *        %s ones must outlive the record too
+ */
+typedef struct dd_log_record {
+    volatile uint32_t sequence;
+    const char *fmt;
+    uintptr_t args[DD_LOG_MAX_ARGS];
+} dd_log_record_t;
+
+/**
+ * @brief Log ring counters
+ *
+ * @param logged (uint32_t) Records written since the start
+ * @param dropped (uint32_t) Records dropped because the ring was full
+ * @param high_water_mark (uint32_t) Most records ever waiting for the drain
+ */
+typedef struct dd_log_stats {
+    uint32_t logged;
+    uint32_t dropped;
+    uint32_t high_water_mark;
+} dd_log_stats_t;
+
+
+void init_dd_log(void);
+bool dd_log(const char *fmt, ...);
+uint32_t dd_log_drain(uint32_t max_records);
+uint32_t dd_log_pending(void);
+void get_dd_log_stats(dd_log_stats_t *stats);
+
+
+#endif
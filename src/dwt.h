@@ -0,0 +1,17 @@
+#ifndef DWT_H
+#define DWT_H
+
+/* Standard includes. */
+#include <stdint.h>
+
+/**
+ * @brief Registers of the Cortex-M4 DWT cycle counter, used by cycle_stats.c
+ *        and workload.c. The DWT is not described by the CMSIS core_cm4.h of
+ *        this tree. The counter also needs TRCENA set in CoreDebug->DEMCR.
+ */
+#define DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+#define DWT_CTRL_CYCCNTENA (1UL << 0)
+
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ * @file bench_task_list.c
+ * @brief Host benchmark comparing the sorted linked list and the binary
+ *    min-heap used for the active DD-task list. Each structure is filled with
+ *    N jobs and then driven the way DDS_Task drives it: a release inserts a
+ *    job, the earliest deadline is read, and a completion removes a job by id.
+ *
+ *    Build and run with `make bench` from src/.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../linked_list.h"
+
+#define BENCH_OPS 20000
+
+static const int bench_sizes[] = { 10, 100, 1000 };
+
+/**
+ * @brief Node pool exhaustion hook required by linked_list.c
+ *
+ * @return (void)
+ */
+void vApplicationTaskPoolExhaustedHook(void) {
+    fprintf(stderr, "node pool exhausted, increase DD_TASK_POOL_SIZE\n");
+    exit(1);
+}
+
+/**
+ * @brief Monotonic time in nanoseconds
+ *
+ * @return (double) Current time in ns
+ */
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * @brief Build a job with a pseudo random deadline after the given time
+ *
+ * @param task_id (uint32_t) [IN] Task id of the job
+ * @param now (uint32_t) [IN] Release time of the job
+ * @return (dd_task_t) The job
+ */
+static dd_task_t make_job(uint32_t task_id, uint32_t now) {
+    dd_task_t task;
+    task.t_handle = NULL;
+    task.type = PERIODIC;
+    task.task_id = task_id;
+    task.release_time = now;
+    task.absolute_deadline = now + 1 + (uint32_t)(rand() % 1000);
+    task.completion_time = 0;
+    task.user_task_id = task_id % 3 + 1;
+    return task;
+}
+
+/**
+ * @brief Steady state release/complete cycle on the linked list with n jobs
+ *
+ * @param n (int) [IN] Number of jobs in flight
+ * @return (double) Average ns per release + peek + completion
+ */
+static double bench_list(int n) {
+    dd_task_list_t list;
+    init_task_list(&list);
+    uint32_t next_id = 0;
+    srand(1);
+    for (int i = 0; i < n; i++) {
+        push(&list, make_job(next_id++, 0));
+    }
+    volatile uint32_t sink = 0;
+    double start = now_ns();
+    for (int i = 0; i < BENCH_OPS; i++) {
+        push(&list, make_job(next_id++, (uint32_t)i));
+        sink += get_head(&list)->task.absolute_deadline;
+        // Complete a job picked at random among those in flight
+        uint32_t victim = next_id - 1 - (uint32_t)(rand() % (n + 1));
+        while (get_task(&list, victim) == NULL) {
+            victim = (victim + 1) % next_id;
+        }
+        remove_task(&list, victim);
+    }
+    double elapsed = now_ns() - start;
+    free_list(&list);
+    (void)sink;
+    return elapsed / BENCH_OPS;
+}
+
+/**
+ * @brief Steady state release/complete cycle on the heap with n jobs
+ *
+ * @param n (int) [IN] Number of jobs in flight
+ * @return (double) Average ns per release + peek + completion
+ */
+static double bench_heap(int n) {
+    dd_task_node_t **storage = malloc(sizeof(dd_task_node_t *) * (n + 1));
+    dd_task_node_t **index = malloc(sizeof(dd_task_node_t *) * DD_TASK_INDEX_SIZE(n + 1));
+    dd_task_heap_t heap;
+    init_task_heap(&heap, storage, n + 1, index, DD_TASK_INDEX_SIZE(n + 1));
+    uint32_t next_id = 0;
+    srand(1);
+    for (int i = 0; i < n; i++) {
+        heap_push(&heap, make_job(next_id++, 0));
+    }
+    volatile uint32_t sink = 0;
+    double start = now_ns();
+    for (int i = 0; i < BENCH_OPS; i++) {
+        heap_push(&heap, make_job(next_id++, (uint32_t)i));
+        sink += heap_peek(&heap)->task.absolute_deadline;
+        uint32_t victim = next_id - 1 - (uint32_t)(rand() % (n + 1));
+        while (heap_get_task(&heap, victim) == NULL) {
+            victim = (victim + 1) % next_id;
+        }
+        heap_remove_task(&heap, victim);
+    }
+    double elapsed = now_ns() - start;
+    free_heap(&heap);
+    free(storage);
+    free(index);
+    (void)sink;
+    return elapsed / BENCH_OPS;
+}
+
+int main(void) {
+    printf("Jobs\tList (ns/op)\tHeap (ns/op)\n");
+    for (size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i++) {
+        int n = bench_sizes[i];
+        double list_ns = bench_list(n);
+        double heap_ns = bench_heap(n);
+        printf("%d\t%.1f\t\t%.1f\n", n, list_ns, heap_ns);
+    }
+    return 0;
+}
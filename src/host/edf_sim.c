@@ -0,0 +1,596 @@
+/**
+ * @file edf_sim.c
+ * @brief Discrete event simulator of the DD scheduler on one processor, for
+ *    checking task sets before they are flashed. Jobs are dd_task_t kept in
+ *    the same dd_task_heap_t as the active task list of DDS_Task, so they
+ *    are run in exactly the order the DDS would pick them, ties included.
+ *    Time jumps from one event (a release, a completion or a deadline) to
+ *    the next instead of stepping through every tick.
+ *
+ *    By default a job that reaches its deadline with work left is cancelled
+ *    there, as handle_overdue_tasks() does one tick later, and a release is
+ *    dropped when -w jobs are already in flight, as with a full worker pool.
+ *    With -c overdue jobs run to completion instead, which gives their real
+ *    lateness. The lateness of a cancelled job is the work it had left when
+ *    it was cancelled, the least it would have been late by.
+ *
+ *    Task sets are one of the test benches of task_sets.h, which main.c
+ *    runs (-b), or random sets of n periodic tasks (-n) with utilizations
+ *    drawn by UUniFast and periods drawn log-uniform (-p). Giving -u a range sweeps the utilization and
+ *    prints the miss ratio at each point. Otherwise the per-task misses,
+ *    lateness and response times of the set are printed, and -j prints the
+ *    completed and overdue jobs in the layout of the Monitor_Task output,
+ *    to compare with test1_out.txt.
+ *
+ *    Only periodic tasks are simulated, there is no aperiodic server. Build
+ *    with `make edf_sim` from src/, run `./edf_sim -h` for the options.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../linked_list.h"
+#include "../task_sets.h"
+
+/* Largest number of tasks in a set. */
+#define SIM_MAX_TASKS 256
+
+/* Largest number of jobs in flight, the active heap capacity. */
+#define SIM_MAX_ACTIVE (DD_TASK_POOL_SIZE - SIM_MAX_TASKS)
+
+/* Response time histograms have 1 ms bins up to this many relative
+deadlines, and one bin for everything above. */
+#define SIM_HIST_DEADLINES 4
+
+/**
+ * @brief Periodic task of a simulated set. All times are in ms.
+ *
+ * @param period (uint32_t) Period
+ * @param execution_time (uint32_t) Execution time of every job
+ * @param relative_deadline (uint32_t) Relative deadline
+ * @param phase (uint32_t) Time of the first release
+ */
+typedef struct sim_task {
+    uint32_t period;
+    uint32_t execution_time;
+    uint32_t relative_deadline;
+    uint32_t phase;
+} sim_task_t;
+
+/**
+ * @brief Results of a task over a run
+ *
+ * @param released (uint32_t) Jobs released
+ * @param dropped (uint32_t) Jobs not released because the active list was full
+ * @param completed (uint32_t) Jobs completed, on time or late
+ * @param missed (uint32_t) Jobs completed late or cancelled
+ * @param max_lateness (uint32_t) Largest lateness of a missed job
+ * @param response_min (uint32_t) Shortest response time of a completed job
+ * @param response_max (uint32_t) Longest response time of a completed job
+ * @param response_total (uint64_t) Sum of the response times, for the mean
+ * @param hist (uint32_t *) Response time histogram, hist_bins bins of 1 ms
+ * @param hist_bins (uint32_t) Number of bins, the last one counts everything above
+ * @param pending (uint32_t) Jobs in flight
+ * @param remaining (uint32_t) Execution left to the oldest job in flight
+ */
+typedef struct sim_task_stats {
+    uint32_t released;
+    uint32_t dropped;
+    uint32_t completed;
+    uint32_t missed;
+    uint32_t max_lateness;
+    uint32_t response_min;
+    uint32_t response_max;
+    uint64_t response_total;
+    uint32_t *hist;
+    uint32_t hist_bins;
+    uint32_t pending;
+    uint32_t remaining;
+} sim_task_stats_t;
+
+/**
+ * @brief Options of a run
+ *
+ * @param horizon (uint32_t) Simulated time in ms
+ * @param max_active (int) Jobs in flight before releases are dropped
+ * @param run_late (bool) Run overdue jobs to completion instead of cancelling them
+ * @param print_jobs (uint32_t) Number of completed and overdue jobs to print
+ */
+typedef struct sim_options {
+    uint32_t horizon;
+    int max_active;
+    bool run_late;
+    uint32_t print_jobs;
+} sim_options_t;
+
+/**
+ * @brief Totals of a run
+ *
+ * @param released (uint64_t) Jobs released
+ * @param missed (uint64_t) Jobs completed late or cancelled
+ * @param dropped (uint64_t) Jobs dropped
+ * @param preemptions (uint64_t) Jobs preempted by a job with an earlier deadline
+ */
+typedef struct sim_totals {
+    uint64_t released;
+    uint64_t missed;
+    uint64_t dropped;
+    uint64_t preemptions;
+} sim_totals_t;
+
+/**
+ * @brief Row of a test bench of task_sets.h
+ *
+ * @param type (task_type_t) PERIODIC or APERIODIC, only periodic rows are simulated
+ * @param task (sim_task_t) Times of the row, the relative deadline filled in
+ */
+typedef struct sim_bench_row {
+    task_type_t type;
+    sim_task_t task;
+} sim_bench_row_t;
+
+/* The LED and the workload of a row do not matter here. */
+#define SIM_BENCH_ROW(type, period, execution_time, relative_deadline, phase, led, workload) \
+    { type, { period, execution_time, (relative_deadline) != 0 ? (relative_deadline) : (period), phase } },
+
+static const sim_bench_row_t test_bench_1[] = { TEST_BENCH_1(SIM_BENCH_ROW) };
+static const sim_bench_row_t test_bench_2[] = { TEST_BENCH_2(SIM_BENCH_ROW) };
+static const sim_bench_row_t test_bench_3[] = { TEST_BENCH_3(SIM_BENCH_ROW) };
+static const sim_bench_row_t test_bench_4[] = { TEST_BENCH_4(SIM_BENCH_ROW) };
+
+#define SIM_BENCH(rows) { rows, sizeof(rows) / sizeof(rows[0]) }
+
+/* Test benches by number, from 1. */
+static const struct {
+    const sim_bench_row_t *rows;
+    uint32_t size;
+} sim_benches[] = {
+    SIM_BENCH(test_bench_1), SIM_BENCH(test_bench_2), SIM_BENCH(test_bench_3), SIM_BENCH(test_bench_4)
+};
+
+static uint64_t rng_state = 1;
+
+/**
+ * @brief Node pool exhaustion hook required by linked_list.c
+ *
+ * @return (void)
+ */
+void vApplicationTaskPoolExhaustedHook(void) {
+    fprintf(stderr, "node pool exhausted, increase DD_TASK_POOL_SIZE\n");
+    exit(1);
+}
+
+/**
+ * @brief Monotonic time in seconds
+ *
+ * @return (double) Current time in s
+ */
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Uniform random number in [0, 1), xorshift64*
+ *
+ * @return (double) The number
+ */
+static double rng_uniform(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (double)((rng_state * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Draw a random task set. Utilizations come from UUniFast (Bini and
+ *        Buttazzo), so every split of the total is equally likely. Periods
+ *        are log-uniform in [period_min, period_max], rounded to granularity,
+ *        and execution times are rounded to at least 1 ms. Deadlines are
+ *        implicit and every phase is 0.
+ *
+ * @param tasks (sim_task_t *) [OUT] The n tasks
+ * @param n (int) [IN] Number of tasks
+ * @param utilization (double) [IN] Total utilization before rounding
+ * @param period_min (uint32_t) [IN] Shortest period in ms
+ * @param period_max (uint32_t) [IN] Longest period in ms
+ * @param granularity (uint32_t) [IN] Periods are a multiple of this, in ms
+ * @return (void)
+ */
+static void generate_task_set(sim_task_t *tasks, int n, double utilization,
+    uint32_t period_min, uint32_t period_max, uint32_t granularity) {
+    double sum = utilization;
+    double log_min = log((double)period_min);
+    double log_max = log((double)period_max);
+    for (int i = 0; i < n; i++) {
+        double u = sum;
+        if (i < n - 1) {
+            double next = sum * pow(rng_uniform(), 1.0 / (double)(n - 1 - i));
+            u = sum - next;
+            sum = next;
+        }
+        double period = exp(log_min + (log_max - log_min) * rng_uniform());
+        uint32_t rounded = (uint32_t)(period / granularity + 0.5) * granularity;
+        tasks[i].period = rounded < granularity ? granularity : rounded;
+        tasks[i].execution_time = (uint32_t)(u * tasks[i].period + 0.5);
+        if (tasks[i].execution_time == 0) {
+            tasks[i].execution_time = 1;
+        }
+        tasks[i].relative_deadline = tasks[i].period;
+        tasks[i].phase = 0;
+    }
+}
+
+/**
+ * @brief Utilization of a task set
+ *
+ * @param tasks (const sim_task_t *) [IN] The tasks
+ * @param n (int) [IN] Number of tasks
+ * @return (double) Sum of execution time over period
+ */
+static double task_set_utilization(const sim_task_t *tasks, int n) {
+    double u = 0.0;
+    for (int i = 0; i < n; i++) {
+        u += (double)tasks[i].execution_time / tasks[i].period;
+    }
+    return u;
+}
+
+/**
+ * @brief Print a completed or overdue job in the Monitor_Task layout
+ *
+ * @param list_name (const char *) [IN] "Completed" or "Overdue"
+ * @param task (const dd_task_t *) [IN] The job
+ * @return (void)
+ */
+static void print_job(const char *list_name, const dd_task_t *task) {
+    printf("%-9s  " DD_TASK_LIST_ROW, list_name, task->user_task_id, task->release_time,
+        task->absolute_deadline, task->completion_time);
+}
+
+/**
+ * @brief Account for the oldest job of a task leaving the active list
+ *
+ * @param tasks (const sim_task_t *) [IN] The task set
+ * @param stats (sim_task_stats_t *) [IN] Results of every task
+ * @param totals (sim_totals_t *) [IN] Totals of the run
+ * @param options (const sim_options_t *) [IN] Options of the run
+ * @param task (dd_task_t *) [IN] The job, completion_time set if it completed
+ * @param lateness (uint32_t) [IN] How late the job is or would be, 0 if on time
+ * @param cancelled (bool) [IN] true if the job was cancelled rather than completed
+ * @return (void)
+ */
+static void retire_job(const sim_task_t *tasks, sim_task_stats_t *stats, sim_totals_t *totals,
+    const sim_options_t *options, dd_task_t *task, uint32_t lateness, bool cancelled) {
+    uint32_t index = task->user_task_id - 1;
+    sim_task_stats_t *s = &stats[index];
+
+    if (!cancelled) {
+        uint32_t response = task->completion_time - task->release_time;
+        if (s->completed == 0 || response < s->response_min) {
+            s->response_min = response;
+        }
+        if (response > s->response_max) {
+            s->response_max = response;
+        }
+        s->response_total += response;
+        s->hist[response < s->hist_bins - 1 ? response : s->hist_bins - 1]++;
+        s->completed++;
+    }
+    if (lateness > 0 || cancelled) {
+        s->missed++;
+        totals->missed++;
+        if (lateness > s->max_lateness) {
+            s->max_lateness = lateness;
+        }
+    }
+    if (options->print_jobs > 0 && s->completed + s->missed <= options->print_jobs) {
+        print_job(cancelled ? "Overdue" : "Completed", task);
+    }
+
+    s->pending--;
+    s->remaining = tasks[index].execution_time;
+}
+
+/**
+ * @brief Run a task set under EDF from time 0 to the horizon. Pending
+ *        releases are kept in a second heap, keyed on the time of the next
+ *        release through absolute_deadline and on the task index through
+ *        task_id. The jobs of a task have increasing deadlines, so they run
+ *        one after the other and only the oldest one can be partly run.
+ *
+ * @param tasks (const sim_task_t *) [IN] The task set
+ * @param n (int) [IN] Number of tasks
+ * @param options (const sim_options_t *) [IN] Options of the run
+ * @param stats (sim_task_stats_t *) [OUT] Results of every task, histograms allocated
+ * @param totals (sim_totals_t *) [OUT] Totals of the run
+ * @return (void)
+ */
+static void simulate(const sim_task_t *tasks, int n, const sim_options_t *options,
+    sim_task_stats_t *stats, sim_totals_t *totals) {
+    static dd_task_node_t *active_storage[SIM_MAX_ACTIVE];
+    static dd_task_node_t *active_index[DD_TASK_INDEX_SIZE(SIM_MAX_ACTIVE)];
+    static dd_task_node_t *release_storage[SIM_MAX_TASKS];
+    static dd_task_node_t *release_index[DD_TASK_INDEX_SIZE(SIM_MAX_TASKS)];
+    dd_task_heap_t active;
+    dd_task_heap_t releases;
+    init_task_heap(&active, active_storage, options->max_active,
+        active_index, DD_TASK_INDEX_SIZE(SIM_MAX_ACTIVE));
+    init_task_heap(&releases, release_storage, SIM_MAX_TASKS,
+        release_index, DD_TASK_INDEX_SIZE(SIM_MAX_TASKS));
+
+    memset(totals, 0, sizeof(*totals));
+    for (int i = 0; i < n; i++) {
+        uint32_t *hist = stats[i].hist;
+        uint32_t bins = tasks[i].relative_deadline * SIM_HIST_DEADLINES + 2;
+        if (hist == NULL || stats[i].hist_bins != bins) {
+            free(hist);
+            hist = malloc(sizeof(uint32_t) * bins);
+        }
+        memset(&stats[i], 0, sizeof(stats[i]));
+        memset(hist, 0, sizeof(uint32_t) * bins);
+        stats[i].hist = hist;
+        stats[i].hist_bins = bins;
+        stats[i].remaining = tasks[i].execution_time;
+
+        dd_task_t release = { NULL, PERIODIC, (uint32_t)i, 0, tasks[i].phase, 0, (uint32_t)i + 1 };
+        heap_push(&releases, release);
+    }
+
+    uint32_t now = 0;
+    uint32_t next_job_id = 0;
+    uint32_t running_id = 0;
+    bool running = false;
+
+    while (now < options->horizon) {
+        // Release every job due now and set the next release of its task
+        dd_task_node_t *next = heap_peek(&releases);
+        while (next != NULL && next->task.absolute_deadline <= now) {
+            uint32_t index = next->task.task_id;
+            const sim_task_t *task = &tasks[index];
+            dd_task_t job = { NULL, PERIODIC, next_job_id++, next->task.absolute_deadline,
+                next->task.absolute_deadline + task->relative_deadline, 0, index + 1 };
+            stats[index].released++;
+            totals->released++;
+            if (heap_push(&active, job)) {
+                stats[index].pending++;
+            } else {
+                stats[index].dropped++;
+                totals->dropped++;
+            }
+            dd_task_t release = next->task;
+            release.absolute_deadline += task->period;
+            heap_remove_task(&releases, index);
+            heap_push(&releases, release);
+            next = heap_peek(&releases);
+        }
+        uint32_t next_release = next->task.absolute_deadline;
+        if (next_release > options->horizon) {
+            next_release = options->horizon;
+        }
+
+        dd_task_node_t *head = heap_peek(&active);
+        if (head == NULL) {
+            running = false;
+            now = next_release;
+            continue;
+        }
+
+        dd_task_t *job = &head->task;
+        sim_task_stats_t *s = &stats[job->user_task_id - 1];
+        if (running && running_id != job->task_id && heap_get_task(&active, running_id) != NULL) {
+            totals->preemptions++;
+        }
+        running = true;
+        running_id = job->task_id;
+
+        // The job runs until it completes, a release may preempt it, or it
+        // reaches its deadline with work left and is cancelled
+        uint32_t until = next_release;
+        if (!options->run_late && job->absolute_deadline < until) {
+            until = job->absolute_deadline;
+        }
+        if (until <= now) {
+            // Only a job at its deadline can get here
+            retire_job(tasks, stats, totals, options, job, now + s->remaining - job->absolute_deadline, true);
+            heap_remove_task(&active, job->task_id);
+            running = false;
+        } else if (now + s->remaining <= until) {
+            now += s->remaining;
+            job->completion_time = now;
+            retire_job(tasks, stats, totals, options, job,
+                now > job->absolute_deadline ? now - job->absolute_deadline : 0, false);
+            heap_remove_task(&active, job->task_id);
+            running = false;
+        } else {
+            s->remaining -= until - now;
+            now = until;
+        }
+    }
+
+    free_heap(&active);
+    free_heap(&releases);
+}
+
+/**
+ * @brief Response time below which a fraction of the completed jobs fall
+ *
+ * @param s (const sim_task_stats_t *) [IN] Results of the task
+ * @param fraction (double) [IN] Fraction of the jobs, 0.5 for the median
+ * @return (uint32_t) Response time in ms
+ */
+static uint32_t response_percentile(const sim_task_stats_t *s, double fraction) {
+    uint64_t target = (uint64_t)(fraction * s->completed + 0.5);
+    uint64_t count = 0;
+    if (target == 0) {
+        target = 1;
+    }
+    for (uint32_t bin = 0; bin < s->hist_bins - 1; bin++) {
+        count += s->hist[bin];
+        if (count >= target) {
+            return bin;
+        }
+    }
+    return s->response_max;
+}
+
+/**
+ * @brief Print the results of every task of a run
+ *
+ * @param tasks (const sim_task_t *) [IN] The task set
+ * @param n (int) [IN] Number of tasks
+ * @param stats (const sim_task_stats_t *) [IN] Results of every task
+ * @param totals (const sim_totals_t *) [IN] Totals of the run
+ * @return (void)
+ */
+static void print_report(const sim_task_t *tasks, int n, const sim_task_stats_t *stats,
+    const sim_totals_t *totals) {
+    printf("UserTID\tPeriod\tExec\tDeadline\tReleased\tCompleted\tMissed\tDropped\tMaxLate\t"
+        "RespMin\tRespMean\tRespP50\tRespP90\tRespP99\tRespMax\n");
+    for (int i = 0; i < n; i++) {
+        const sim_task_stats_t *s = &stats[i];
+        uint32_t mean = s->completed > 0 ? (uint32_t)(s->response_total / s->completed) : 0;
+        printf("%d\t%u\t%u\t%u\t\t%u\t\t%u\t\t%u\t%u\t%u\t%u\t%u\t\t%u\t%u\t%u\t%u\n", i + 1,
+            tasks[i].period, tasks[i].execution_time, tasks[i].relative_deadline,
+            s->released, s->completed, s->missed, s->dropped, s->max_lateness,
+            s->response_min, mean, response_percentile(s, 0.5), response_percentile(s, 0.9),
+            response_percentile(s, 0.99), s->response_max);
+    }
+    printf("Utilization %.4f, %llu jobs, %llu missed, %llu dropped, %llu preemptions\n",
+        task_set_utilization(tasks, n), (unsigned long long)totals->released,
+        (unsigned long long)totals->missed, (unsigned long long)totals->dropped,
+        (unsigned long long)totals->preemptions);
+}
+
+/**
+ * @brief Print the options
+ *
+ * @param name (const char *) [IN] Program name
+ * @return (void)
+ */
+static void usage(const char *name) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -b bench     run test bench 1 to 4 of task_sets.h\n"
+        "  -n tasks     tasks per random set (default 10, at most %d)\n"
+        "  -u lo[:hi:step]\n"
+        "               utilization of the random sets, or a sweep (default 0.9)\n"
+        "  -s sets      random sets per utilization (default 1)\n"
+        "  -p min:max   period range in ms, log-uniform (default 100:1000)\n"
+        "  -g ms        period granularity (default 10)\n"
+        "  -t ms        simulated time per set (default 100000)\n"
+        "  -w jobs      jobs in flight before releases are dropped (default %d)\n"
+        "  -c           run overdue jobs to completion instead of cancelling them\n"
+        "  -j jobs      print the first completed and overdue jobs of each task\n"
+        "  -r seed      random seed (default 1)\n",
+        name, SIM_MAX_TASKS, SIM_MAX_ACTIVE);
+}
+
+int main(int argc, char **argv) {
+    static sim_task_t tasks[SIM_MAX_TASKS];
+    static sim_task_stats_t stats[SIM_MAX_TASKS];
+    sim_options_t options = { 100000, SIM_MAX_ACTIVE, false, 0 };
+    int bench = 0;
+    int n = 10;
+    int sets = 1;
+    double u_lo = 0.9;
+    double u_hi = 0.9;
+    double u_step = 0.1;
+    unsigned int period_min = 100;
+    unsigned int period_max = 1000;
+    unsigned int granularity = 10;
+    unsigned long long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:n:u:s:p:g:t:w:cj:r:h")) != -1) {
+        switch (opt) {
+        case 'b': bench = atoi(optarg); break;
+        case 'n': n = atoi(optarg); break;
+        case 'u':
+            if (sscanf(optarg, "%lf:%lf:%lf", &u_lo, &u_hi, &u_step) < 3) {
+                u_hi = u_lo;
+            }
+            break;
+        case 's': sets = atoi(optarg); break;
+        case 'p': sscanf(optarg, "%u:%u", &period_min, &period_max); break;
+        case 'g': granularity = (unsigned int)atoi(optarg); break;
+        case 't': options.horizon = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'w': options.max_active = atoi(optarg); break;
+        case 'c': options.run_late = true; break;
+        case 'j': options.print_jobs = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'r': seed = strtoull(optarg, NULL, 10); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (n < 1 || n > SIM_MAX_TASKS || sets < 1 || granularity == 0 || period_min == 0 ||
+        period_max < period_min || u_lo <= 0.0 || u_step <= 0.0 || u_hi < u_lo ||
+        options.max_active < 1 || options.max_active > SIM_MAX_ACTIVE ||
+        options.horizon == 0 || options.horizon > 0x7FFFFFFF) {
+        usage(argv[0]);
+        return 1;
+    }
+    rng_state = seed == 0 ? 1 : seed;
+
+    if (bench != 0) {
+        if (bench < 1 || bench > (int)(sizeof(sim_benches) / sizeof(sim_benches[0]))) {
+            usage(argv[0]);
+            return 1;
+        }
+        const sim_bench_row_t *set = sim_benches[bench - 1].rows;
+        uint32_t rows = sim_benches[bench - 1].size;
+        n = 0;
+        for (uint32_t i = 0; i < rows; i++) {
+            if (set[i].type == PERIODIC) {
+                tasks[n++] = set[i].task;
+            }
+        }
+        sim_totals_t totals;
+        simulate(tasks, n, &options, stats, &totals);
+        print_report(tasks, n, stats, &totals);
+        return 0;
+    }
+
+    if (sets == 1 && u_hi == u_lo) {
+        generate_task_set(tasks, n, u_lo, period_min, period_max, granularity);
+        sim_totals_t totals;
+        simulate(tasks, n, &options, stats, &totals);
+        print_report(tasks, n, stats, &totals);
+        return 0;
+    }
+
+    // Sweep, a set is schedulable if none of its jobs missed or was dropped.
+    // Rounding execution times to whole ms moves the utilization of a set
+    // away from the one asked for, the mean of the sets is printed as well.
+    printf("Util\tMean\tSets\tSchedulable\tJobs\t\tMissed\t\tMiss ratio\tJobs/s\n");
+    for (int point = 0; u_lo + point * u_step <= u_hi + 1e-9; point++) {
+        double u = u_lo + point * u_step;
+        uint64_t jobs = 0;
+        uint64_t missed = 0;
+        double mean_u = 0.0;
+        int schedulable = 0;
+        double start = now_s();
+        for (int set = 0; set < sets; set++) {
+            sim_totals_t totals;
+            generate_task_set(tasks, n, u, period_min, period_max, granularity);
+            mean_u += task_set_utilization(tasks, n) / sets;
+            simulate(tasks, n, &options, stats, &totals);
+            jobs += totals.released;
+            missed += totals.missed + totals.dropped;
+            if (totals.missed + totals.dropped == 0) {
+                schedulable++;
+            }
+        }
+        double elapsed = now_s() - start;
+        printf("%.3f\t%.3f\t%d\t%d\t\t%llu\t%llu\t\t%.6f\t%.0f\n", u, mean_u, sets, schedulable,
+            (unsigned long long)jobs, (unsigned long long)missed,
+            jobs > 0 ? (double)missed / (double)jobs : 0.0, elapsed > 0.0 ? jobs / elapsed : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef FREERTOS_SIM_CONFIG_H
+#define FREERTOS_SIM_CONFIG_H
+
+/*-----------------------------------------------------------
+ * Configuration of the simulated host build (see Makefile). It is the
+ * firmware configuration, with the few settings that depend on the target
+ * replaced.
+ *----------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../FreeRTOSConfig.h"
+
+/* The release engine is polled from the tick hook, there is no TIM2. */
+#undef configUSE_TICK_HOOK
+#define configUSE_TICK_HOOK				1
+
+/* Pointers, and so TCBs and queues, are twice as large on a 64-bit host. */
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 256 * 1024 ) )
+
+/* Task stacks are not used by the simulated port, the pthreads have their
+own, so there is nothing to check. */
+#undef configCHECK_FOR_STACK_OVERFLOW
+#define configCHECK_FOR_STACK_OVERFLOW	0
+
+#undef configASSERT
+#define configASSERT( x ) if( ( x ) == 0 ) { fprintf( stderr, "%s:%d: assertion failed\n", __FILE__, __LINE__ ); abort(); }
+
+#endif /* FREERTOS_SIM_CONFIG_H */
@@ -0,0 +1,92 @@
+/**
+ * @file sim_board.c
+ * @brief Board support for the simulated host build of the DD scheduler
+ *    (see Makefile): LEDs that only keep their state, and the tick hook that
+ *    stands in for the TIM2 interrupt of the release engine. printf goes
+ *    straight to stdout instead of the ITM.
+ *
+ *    When the DD_SIM_TRACE environment variable names a file, the scheduler
+ *    trace ring is dumped to it at the end of the run, in the layout the
+ *    host decoder reads from a target memory dump. Records still in the log
+ *    ring at the end of the run are printed then too.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "stm32f4_discovery.h"
+#include "../../release_engine.h"
+#include "../../sched_trace.h"
+#include "../../dd_log.h"
+
+uint32_t SystemCoreClock = 168000000;
+
+static bool led_state[LEDn];
+
+void STM_EVAL_LEDInit(Led_TypeDef Led) {
+    led_state[Led] = false;
+}
+
+void STM_EVAL_LEDOn(Led_TypeDef Led) {
+    led_state[Led] = true;
+}
+
+void STM_EVAL_LEDOff(Led_TypeDef Led) {
+    led_state[Led] = false;
+}
+
+void STM_EVAL_LEDToggle(Led_TypeDef Led) {
+    led_state[Led] = !led_state[Led];
+}
+
+/**
+ * @brief Called by the kernel on every simulated tick, in interrupt context
+ *
+ * @return (void)
+ */
+void vApplicationTickHook(void) {
+    release_engine_irq_handler();
+}
+
+/**
+ * @brief Write the trace ring to the file named by DD_SIM_TRACE
+ *
+ * @return (void)
+ */
+static void dump_sched_trace(void) {
+#if ( SCHED_TRACE_ENABLE == 1 )
+    const char *path = getenv("DD_SIM_TRACE");
+    if (path == NULL) {
+        return;
+    }
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        perror(path);
+        return;
+    }
+    fwrite(&sched_trace_buffer, sizeof(sched_trace_buffer), 1, file);
+    fclose(file);
+#endif
+}
+
+/**
+ * @brief Print what the log task had not printed yet when the run ended
+ *
+ * @return (void)
+ */
+static void flush_dd_log(void) {
+    dd_log_drain(UINT32_MAX);
+    fflush(stdout);
+}
+
+/**
+ * @brief Runs before main(), the run ends with exit() from the port
+ *
+ * @return (void)
+ */
+__attribute__((constructor)) static void register_sched_trace_dump(void) {
+    atexit(dump_sched_trace);
+    atexit(flush_dd_log);
+}
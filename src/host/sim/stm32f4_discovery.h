@@ -0,0 +1,22 @@
+#ifndef STM32F4_DISCOVERY_SIM_H
+#define STM32F4_DISCOVERY_SIM_H
+
+/* Stand-in for the STM32F4 Discovery board header in the simulated host
+build (see Makefile). The LEDs only keep their state, in sim_board.c. */
+
+typedef enum
+{
+  LED4 = 0,
+  LED3 = 1,
+  LED5 = 2,
+  LED6 = 3
+} Led_TypeDef;
+
+#define LEDn                             4
+
+void STM_EVAL_LEDInit(Led_TypeDef Led);
+void STM_EVAL_LEDOn(Led_TypeDef Led);
+void STM_EVAL_LEDOff(Led_TypeDef Led);
+void STM_EVAL_LEDToggle(Led_TypeDef Led);
+
+#endif
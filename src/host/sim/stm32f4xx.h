@@ -0,0 +1,16 @@
+#ifndef STM32F4XX_SIM_H
+#define STM32F4XX_SIM_H
+
+/* Stand-in for the device header in the simulated host build (see Makefile).
+Only what the scheduler sources use outside of DD_SIM_BUILD guards. */
+
+#include <stdint.h>
+
+extern uint32_t SystemCoreClock;
+
+static inline void NVIC_SetPriorityGrouping(uint32_t PriorityGroup)
+{
+  (void)PriorityGroup;
+}
+
+#endif
@@ -0,0 +1,485 @@
+/**
+ * @file trace_decode.c
+ * @brief Host decoder of the scheduler trace written by sched_trace.c. The
+ *    input is either a memory dump holding sched_trace_buffer (for example
+ *    `dump binary value sched_trace_buffer` in gdb, or the DD_SIM_TRACE file
+ *    of the simulated build), searched for the trace magic, or with -i an
+ *    SWO capture of the ITM stream, from which the records sent to the
+ *    trace stimulus port are put back together. The records are printed as
+ *    a timeline, oldest first, followed by a count of each event per user
+ *    task. With -j they are converted to Chrome trace-event JSON instead,
+ *    which ui.perfetto.dev and chrome://tracing open: one track per user task
+ *    with a slice for each stretch a job was the one running, its release,
+ *    overdue and drop instants and its response time, one track for the DDS
+ *    with a slice for each event it handled, and a counter of active jobs.
+ *
+ *    Build with `make trace_decode` from src/.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../sched_trace.h"
+
+/* Number of event kinds, SCHED_TRACE_DDS_END is the last. */
+#define TRACE_EVENTS (SCHED_TRACE_DDS_END + 1)
+
+/* Jobs in flight followed by the JSON export, more than the DDS holds. */
+#define TRACE_MAX_JOBS 1024
+
+/* User tasks counted in the summary, others are counted together. */
+#define TRACE_MAX_USER_TASKS 64
+
+/**
+ * @brief Records decoded from the input, in the order they were written
+ *
+ * @param records (sched_trace_record_t *) The records
+ * @param times_us (uint64_t *) Timestamp of each record, unwrapped past 32 bits
+ * @param count (size_t) Number of records
+ * @param lost (uint32_t) Records known to be missing, overwritten or not captured
+ */
+typedef struct trace {
+    sched_trace_record_t *records;
+    uint64_t *times_us;
+    size_t count;
+    uint32_t lost;
+} trace_t;
+
+/**
+ * @brief A job followed by the JSON export
+ *
+ * @param task_id (uint32_t) Task id of the job
+ * @param released (bool) The release of the job is in the trace
+ * @param dispatched (bool) The job is the earliest deadline
+ * @param started (bool) The worker started running the job
+ * @param running_since (uint64_t) Time the job last became the one running
+ */
+typedef struct trace_job {
+    uint32_t task_id;
+    bool released;
+    bool dispatched;
+    bool started;
+    uint64_t running_since;
+} trace_job_t;
+
+static const char *event_names[TRACE_EVENTS] = {
+    "?", "Release", "Dispatch", "Preempt", "Start", "Complete", "Overdue", "Drop", "DDSBegin", "DDSEnd"
+};
+
+/**
+ * @brief Read a whole file
+ *
+ * @param path (const char *) [IN] File name, "-" for stdin
+ * @param size (size_t *) [OUT] Number of bytes read
+ * @return (uint8_t *) The bytes, to free, NULL if the file cannot be read
+ */
+static uint8_t *read_file(const char *path, size_t *size) {
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+    size_t capacity = 1 << 16;
+    uint8_t *data = malloc(capacity);
+    *size = 0;
+    for (;;) {
+        if (*size == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+        size_t n = fread(data + *size, 1, capacity - *size, file);
+        if (n == 0) {
+            break;
+        }
+        *size += n;
+    }
+    if (file != stdin) {
+        fclose(file);
+    }
+    return data;
+}
+
+/**
+ * @brief Find the trace ring in a memory dump and copy its records out,
+ *        oldest first
+ *
+ * @param data (const uint8_t *) [IN] The dump
+ * @param size (size_t) [IN] Size of the dump
+ * @param trace (trace_t *) [OUT] The records
+ * @return (bool) false if no valid trace ring was found
+ */
+static bool decode_dump(const uint8_t *data, size_t size, trace_t *trace) {
+    size_t header = offsetof(sched_trace_buffer_t, records);
+    for (size_t offset = 0; offset + header <= size; offset += sizeof(uint32_t)) {
+        sched_trace_buffer_t buffer;
+        memcpy(&buffer, data + offset, header);
+        if (buffer.magic != SCHED_TRACE_MAGIC) {
+            continue;
+        }
+        if (buffer.version != SCHED_TRACE_VERSION || buffer.record_size != sizeof(sched_trace_record_t) ||
+            buffer.capacity == 0 || (buffer.capacity & (buffer.capacity - 1)) != 0 ||
+            offset + header + (size_t)buffer.capacity * buffer.record_size > size) {
+            fprintf(stderr, "trace ring at offset %zu has an unknown layout\n", offset);
+            return false;
+        }
+        const uint8_t *records = data + offset + header;
+        uint32_t head = buffer.head;
+        uint32_t count = head < buffer.capacity ? head : buffer.capacity;
+        trace->records = malloc(sizeof(sched_trace_record_t) * (count + 1));
+        trace->count = count;
+        trace->lost = head - count;
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t slot = (head - count + i) & (buffer.capacity - 1);
+            memcpy(&trace->records[i], records + (size_t)slot * buffer.record_size, sizeof(sched_trace_record_t));
+        }
+        return true;
+    }
+    fprintf(stderr, "no trace ring found\n");
+    return false;
+}
+
+/**
+ * @brief Put the records sent to an ITM stimulus port back together from an
+ *        SWO capture. Synchronization, overflow, timestamp and hardware
+ *        source packets are skipped, as are the other stimulus ports. A
+ *        capture is assumed to start on a record boundary, gaps in the
+ *        sequence numbers are counted as lost records.
+ *
+ * @param data (const uint8_t *) [IN] The capture
+ * @param size (size_t) [IN] Size of the capture
+ * @param port (unsigned int) [IN] Stimulus port of the trace
+ * @param trace (trace_t *) [OUT] The records
+ * @return (bool) false if the capture holds no record
+ */
+static bool decode_itm(const uint8_t *data, size_t size, unsigned int port, trace_t *trace) {
+    uint8_t *payload = malloc(size + 1);
+    size_t length = 0;
+    size_t i = 0;
+    while (i < size) {
+        uint8_t header = data[i++];
+        if ((header & 0x03) != 0) {
+            // Source packet, 1, 2 or 4 bytes of payload
+            size_t bytes = (header & 0x03) == 3 ? 4 : (header & 0x03);
+            if ((header & 0x04) == 0 && (header >> 3) == port) {
+                for (size_t b = 0; b < bytes && i + b < size; b++) {
+                    payload[length++] = data[i + b];
+                }
+            }
+            i += bytes;
+        } else if ((header & 0x80) != 0 && header != 0x80) {
+            // Timestamp or extension packet, followed by bytes for as long
+            // as bit 7 is set. The 0x80 ending a synchronization packet, its
+            // zeros and overflow packets are single bytes.
+            while (i < size && (data[i++] & 0x80) != 0) {
+            }
+        }
+    }
+
+    size_t count = length / sizeof(sched_trace_record_t);
+    trace->records = malloc(sizeof(sched_trace_record_t) * (count + 1));
+    trace->count = count;
+    trace->lost = 0;
+    memcpy(trace->records, payload, count * sizeof(sched_trace_record_t));
+    free(payload);
+    for (size_t r = 1; r < count; r++) {
+        trace->lost += (uint8_t)(trace->records[r].sequence - trace->records[r - 1].sequence - 1);
+    }
+    if (count == 0) {
+        fprintf(stderr, "no trace record on stimulus port %u\n", port);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Extend the 32-bit timestamps of the records, which wrap every 71
+ *        minutes, assuming records less than that apart
+ *
+ * @param trace (trace_t *) [IN] The records, times_us is allocated
+ * @return (void)
+ */
+static void unwrap_timestamps(trace_t *trace) {
+    trace->times_us = malloc(sizeof(uint64_t) * (trace->count + 1));
+    for (size_t i = 0; i < trace->count; i++) {
+        if (i == 0) {
+            trace->times_us[i] = trace->records[i].timestamp_us;
+        } else {
+            trace->times_us[i] = trace->times_us[i - 1] +
+                (uint32_t)(trace->records[i].timestamp_us - trace->records[i - 1].timestamp_us);
+        }
+    }
+}
+
+/**
+ * @brief Print the records, oldest first
+ *
+ * @param trace (const trace_t *) [IN] The records
+ * @return (void)
+ */
+static void print_timeline(const trace_t *trace) {
+    printf("Time (us)\tEvent\t\tUserTID\tTaskID\n");
+    for (size_t i = 0; i < trace->count; i++) {
+        const sched_trace_record_t *record = &trace->records[i];
+        const char *name = record->event < TRACE_EVENTS ? event_names[record->event] : "?";
+        printf("%llu\t\t%-8s\t%u\t%u\n", (unsigned long long)trace->times_us[i], name,
+            record->user_task_id, record->task_id);
+    }
+}
+
+/**
+ * @brief Find a job followed by the JSON export, adding it if it is new
+ *
+ * @param jobs (trace_job_t *) [IN] Jobs in flight
+ * @param count (size_t *) [IN] Number of jobs in flight
+ * @param task_id (uint32_t) [IN] Task id of the job
+ * @return (trace_job_t *) The job, NULL if too many jobs are in flight
+ */
+static trace_job_t *find_job(trace_job_t *jobs, size_t *count, uint32_t task_id) {
+    for (size_t i = 0; i < *count; i++) {
+        if (jobs[i].task_id == task_id) {
+            return &jobs[i];
+        }
+    }
+    if (*count == TRACE_MAX_JOBS) {
+        return NULL;
+    }
+    trace_job_t *job = &jobs[(*count)++];
+    job->task_id = task_id;
+    job->released = false;
+    job->dispatched = false;
+    job->started = false;
+    job->running_since = 0;
+    return job;
+}
+
+/**
+ * @brief Print one trace event, separated from the previous one
+ *
+ * @param first (bool *) [IN] true until the first event was printed
+ * @param format (const char *) [IN] printf format of the JSON object
+ * @return (void)
+ */
+static void print_json_event(bool *first, const char *format, ...) {
+    va_list args;
+    printf(*first ? "\n" : ",\n");
+    *first = false;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/**
+ * @brief Print the records as Chrome trace-event JSON. A job is running
+ *        while it is both the earliest deadline and started by its worker,
+ *        each such stretch is a slice on the track of its user task. The
+ *        response time of a job is an async slice from release to completion.
+ *        Jobs released before the first record only show from their first
+ *        record on, and are not counted as active.
+ *
+ * @param trace (const trace_t *) [IN] The records
+ * @return (void)
+ */
+static void print_chrome_trace(const trace_t *trace) {
+    static trace_job_t jobs[TRACE_MAX_JOBS];
+    static bool named[TRACE_MAX_USER_TASKS + 1];
+    size_t job_count = 0;
+    bool first = true;
+    bool dds_busy = false;
+    uint64_t dds_since = 0;
+    int32_t active = 0;
+
+    printf("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    print_json_event(&first, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+        "\"args\": {\"name\": \"DD scheduler\"}}");
+    print_json_event(&first, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, "
+        "\"args\": {\"name\": \"DDS\"}}");
+    memset(named, 0, sizeof(named));
+
+    for (size_t i = 0; i < trace->count; i++) {
+        const sched_trace_record_t *record = &trace->records[i];
+        unsigned long long ts = (unsigned long long)trace->times_us[i];
+        unsigned int tid = record->user_task_id;
+
+        if (record->event == SCHED_TRACE_DDS_BEGIN) {
+            dds_busy = true;
+            dds_since = trace->times_us[i];
+            continue;
+        }
+        if (record->event == SCHED_TRACE_DDS_END) {
+            if (dds_busy) {
+                print_json_event(&first, "{\"name\": \"DDS\", \"cat\": \"dds\", \"ph\": \"X\", "
+                    "\"ts\": %llu, \"dur\": %llu, \"pid\": 1, \"tid\": 0}",
+                    (unsigned long long)dds_since, ts - (unsigned long long)dds_since);
+            }
+            dds_busy = false;
+            continue;
+        }
+
+        if (tid <= TRACE_MAX_USER_TASKS && !named[tid]) {
+            named[tid] = true;
+            print_json_event(&first, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+                "\"tid\": %u, \"args\": {\"name\": \"Task %u\"}}", tid, tid);
+            print_json_event(&first, "{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, "
+                "\"tid\": %u, \"args\": {\"sort_index\": %u}}", tid, tid);
+        }
+        if (record->event == SCHED_TRACE_RELEASE || record->event == SCHED_TRACE_DROP ||
+            record->event == SCHED_TRACE_OVERDUE) {
+            print_json_event(&first, "{\"name\": \"%s\", \"cat\": \"job\", \"ph\": \"i\", \"s\": \"t\", "
+                "\"ts\": %llu, \"pid\": 1, \"tid\": %u, \"args\": {\"task_id\": %u}}",
+                event_names[record->event], ts, tid, record->task_id);
+        }
+        if (record->event == SCHED_TRACE_DROP || record->event >= TRACE_EVENTS) {
+            continue;
+        }
+
+        trace_job_t *job = find_job(jobs, &job_count, record->task_id);
+        if (job == NULL) {
+            fprintf(stderr, "more than %d jobs in flight, stopped at record %zu\n", TRACE_MAX_JOBS, i);
+            break;
+        }
+        bool was_running = job->dispatched && job->started;
+        switch (record->event) {
+        case SCHED_TRACE_RELEASE:
+            job->released = true;
+            active++;
+            print_json_event(&first, "{\"name\": \"Job %u\", \"cat\": \"response\", \"ph\": \"b\", "
+                "\"id\": %u, \"ts\": %llu, \"pid\": 1, \"tid\": %u}", record->task_id, record->task_id, ts, tid);
+            print_json_event(&first, "{\"name\": \"Active jobs\", \"ph\": \"C\", \"ts\": %llu, \"pid\": 1, "
+                "\"args\": {\"jobs\": %d}}", ts, active);
+            break;
+        case SCHED_TRACE_DISPATCH: job->dispatched = true; break;
+        case SCHED_TRACE_PREEMPT: job->dispatched = false; break;
+        case SCHED_TRACE_START: job->started = true; break;
+        default: job->dispatched = false; job->started = false; break;
+        }
+        bool running = job->dispatched && job->started;
+        if (running && !was_running) {
+            job->running_since = trace->times_us[i];
+        } else if (was_running && !running) {
+            print_json_event(&first, "{\"name\": \"Job %u\", \"cat\": \"job\", \"ph\": \"X\", "
+                "\"ts\": %llu, \"dur\": %llu, \"pid\": 1, \"tid\": %u, \"args\": {\"end\": \"%s\"}}",
+                record->task_id, (unsigned long long)job->running_since,
+                ts - (unsigned long long)job->running_since, tid, event_names[record->event]);
+        }
+        if ((record->event == SCHED_TRACE_COMPLETE || record->event == SCHED_TRACE_OVERDUE) && job->released) {
+            active--;
+            print_json_event(&first, "{\"name\": \"Job %u\", \"cat\": \"response\", \"ph\": \"e\", "
+                "\"id\": %u, \"ts\": %llu, \"pid\": 1, \"tid\": %u}", record->task_id, record->task_id, ts, tid);
+            print_json_event(&first, "{\"name\": \"Active jobs\", \"ph\": \"C\", \"ts\": %llu, \"pid\": 1, "
+                "\"args\": {\"jobs\": %d}}", ts, active);
+        }
+        if (record->event == SCHED_TRACE_COMPLETE || record->event == SCHED_TRACE_OVERDUE) {
+            *job = jobs[--job_count];
+        }
+    }
+    printf("\n]}\n");
+}
+
+/**
+ * @brief Print the number of each event per user task
+ *
+ * @param trace (const trace_t *) [IN] The records
+ * @return (void)
+ */
+static void print_summary(const trace_t *trace) {
+    static uint32_t counts[TRACE_MAX_USER_TASKS + 1][TRACE_EVENTS];
+    uint32_t last_task = 0;
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < trace->count; i++) {
+        const sched_trace_record_t *record = &trace->records[i];
+        uint32_t task = record->user_task_id < TRACE_MAX_USER_TASKS ? record->user_task_id : TRACE_MAX_USER_TASKS;
+        counts[task][record->event < TRACE_EVENTS ? record->event : 0]++;
+        if (task > last_task) {
+            last_task = task;
+        }
+    }
+    printf("UserTID");
+    for (int event = SCHED_TRACE_RELEASE; event < TRACE_EVENTS; event++) {
+        printf("\t%s", event_names[event]);
+    }
+    printf("\n");
+    for (uint32_t task = 0; task <= last_task; task++) {
+        uint32_t total = 0;
+        for (int event = 0; event < TRACE_EVENTS; event++) {
+            total += counts[task][event];
+        }
+        if (total == 0) {
+            continue;
+        }
+        printf(task < TRACE_MAX_USER_TASKS ? "%u" : ">=%u", task);
+        for (int event = SCHED_TRACE_RELEASE; event < TRACE_EVENTS; event++) {
+            printf("\t%u", counts[task][event]);
+        }
+        printf("\n");
+    }
+    printf("%zu records, %u lost\n", trace->count, trace->lost);
+}
+
+/**
+ * @brief Print the options
+ *
+ * @param name (const char *) [IN] Program name
+ * @return (void)
+ */
+static void usage(const char *name) {
+    fprintf(stderr,
+        "usage: %s [-i] [-p port] [-s | -j] file\n"
+        "  -i        the file is an SWO capture of the ITM stream, not a memory dump\n"
+        "  -p port   stimulus port of the trace in the ITM stream (default %d)\n"
+        "  -s        only print the summary\n"
+        "  -j        print Chrome trace-event JSON, for ui.perfetto.dev or chrome://tracing\n"
+        "  file      input, - for stdin\n",
+        name, SCHED_TRACE_ITM_PORT);
+}
+
+int main(int argc, char **argv) {
+    bool itm = false;
+    bool summary_only = false;
+    bool json = false;
+    unsigned int port = SCHED_TRACE_ITM_PORT;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ip:sjh")) != -1) {
+        switch (opt) {
+        case 'i': itm = true; break;
+        case 'p': port = (unsigned int)atoi(optarg); break;
+        case 's': summary_only = true; break;
+        case 'j': json = true; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind != argc - 1 || port > 31) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    size_t size;
+    uint8_t *data = read_file(argv[optind], &size);
+    if (data == NULL) {
+        return 1;
+    }
+    trace_t trace;
+    bool decoded = itm ? decode_itm(data, size, port, &trace) : decode_dump(data, size, &trace);
+    free(data);
+    if (!decoded) {
+        return 1;
+    }
+    unwrap_timestamps(&trace);
+    if (json) {
+        print_chrome_trace(&trace);
+    } else {
+        if (!summary_only) {
+            print_timeline(&trace);
+        }
+        print_summary(&trace);
+    }
+    free(trace.records);
+    free(trace.times_us);
+    return 0;
+}
@@ -3,7 +3,10 @@
  * @author JJ Carr Cannings, Samuel Barrett
  * @brief This file provides an implementation of a linked list data structure
  *    for use in the EDF scheduler. It is used to store tasks in a linked list
- *    sorted by deadline. It uses dynamic memory allocation to store the nodes.
+ *    sorted by deadline. Nodes come from a fixed size static pool, so no heap
+ *    allocation happens on the scheduler path.
+ *    It also provides an array backed binary min-heap over the same nodes, for
+ *    the active task set where only the earliest deadline is needed quickly.
  * 
  * @version 0.1
  * @date 2022-03-23
@@ -15,6 +18,74 @@
 
 #include "linked_list.h"
 
+/* Static node pool. Free nodes are chained through their next pointer. The
+pool is only used from the DDS task, so it needs no locking. */
+static dd_task_node_t task_pool[DD_TASK_POOL_SIZE];
+static dd_task_node_t *task_pool_free = NULL;
+static bool task_pool_initialised = false;
+static dd_task_pool_stats_t task_pool_stats = { DD_TASK_POOL_SIZE, 0, 0, 0 };
+
+/**
+ * @brief Chain every node of the pool in the free list
+ *
+ * @return (void)
+ */
+static void init_task_pool(void) {
+    for (int i = 0; i < DD_TASK_POOL_SIZE - 1; i++) {
+        task_pool[i].next = &task_pool[i + 1];
+    }
+    task_pool[DD_TASK_POOL_SIZE - 1].next = NULL;
+    task_pool_free = &task_pool[0];
+    task_pool_initialised = true;
+}
+
+/**
+ * @brief Take a node from the pool in O(1)
+ *
+ * @return (dd_task_node_t *) The node, NULL if the pool is exhausted. The
+ *         exhaustion is counted and reported through
+ *         vApplicationTaskPoolExhaustedHook()
+ */
+static dd_task_node_t *alloc_node(void) {
+    if (!task_pool_initialised) {
+        init_task_pool();
+    }
+    dd_task_node_t *node = task_pool_free;
+    if (node == NULL) {
+        task_pool_stats.exhausted_count++;
+        vApplicationTaskPoolExhaustedHook();
+        return NULL;
+    }
+    task_pool_free = node->next;
+    task_pool_stats.in_use++;
+    if (task_pool_stats.in_use > task_pool_stats.high_water_mark) {
+        task_pool_stats.high_water_mark = task_pool_stats.in_use;
+    }
+    return node;
+}
+
+/**
+ * @brief Return a node to the pool in O(1)
+ *
+ * @param node (dd_task_node_t *) [IN] Node previously returned by alloc_node()
+ * @return (void)
+ */
+static void free_node(dd_task_node_t *node) {
+    node->next = task_pool_free;
+    task_pool_free = node;
+    task_pool_stats.in_use--;
+}
+
+/**
+ * @brief Copy the node pool usage counters
+ *
+ * @param stats (dd_task_pool_stats_t *) [OUT] Where to copy the counters
+ * @return (void)
+ */
+void get_task_pool_stats(dd_task_pool_stats_t *stats) {
+    *stats = task_pool_stats;
+}
+
 /**
  * @brief Initialize the linked list
  * 
@@ -50,16 +121,21 @@ dd_task_node_t *get_next(dd_task_node_t *node) {
  * 
  * @param list (dd_task_list_t *) [IN] The linked list to push the task to
  * @param task (dd_task_t) [IN] Task to be pushed
- * @return void
+ * @return (bool) true if the task was pushed, false if the node pool is exhausted
  */
-void push(dd_task_list_t *list, dd_task_t task) {
-    dd_task_node_t *new_node = (dd_task_node_t *) malloc(sizeof(dd_task_node_t));
+bool push(dd_task_list_t *list, dd_task_t task) {
+    dd_task_node_t *new_node = alloc_node();
+    if (new_node == NULL) {
+        return false;
+    }
     new_node->task = task;
     new_node->next = NULL;
+    new_node->heap_index = -1;
     dd_task_node_t *curr = list->head;
     dd_task_node_t *prev = NULL;
 
-    while(curr != NULL && curr->task.absolute_deadline <= task.absolute_deadline) {
+    // Deadlines wrap with the tick count, so compare their difference
+    while(curr != NULL && (int32_t)(curr->task.absolute_deadline - task.absolute_deadline) <= 0) {
         prev = curr;
         curr = curr->next;
     }
@@ -71,6 +147,7 @@ void push(dd_task_list_t *list, dd_task_t task) {
         new_node->next = curr;
     }
     list->size++;
+    return true;
 }
 
 /**
@@ -97,7 +174,7 @@ dd_task_t *get_task(dd_task_list_t *list, uint32_t task_id) {
  * @param list (dd_task_list_t *) [IN] The linked list to remove the task from
  * @param task_id (uint32_t) [IN] The task id to remove
  * @return (TaskHandle_t) The task handle of the removed task if found, NULL otherwise
- * @note This function uses free() to free the memory allocated to the node
+ * @note The node is returned to the node pool
  */
 TaskHandle_t remove_task(dd_task_list_t *list, uint32_t task_id) {
     dd_task_node_t *curr = list->head;
@@ -110,7 +187,7 @@ TaskHandle_t remove_task(dd_task_list_t *list, uint32_t task_id) {
                 prev->next = curr->next;
             }
             TaskHandle_t t_handle = curr->task.t_handle;
-            free(curr);
+            free_node(curr);
             list->size--;
             return t_handle;
         }
@@ -121,7 +198,7 @@ TaskHandle_t remove_task(dd_task_list_t *list, uint32_t task_id) {
 }
 
 /**
- * @brief Free the memory allocated to the linked list and set the size to 0
+ * @brief Return the nodes of the linked list to the pool and set the size to 0
  * 
  * @param list (dd_task_list_t *) [IN] The linked list to free memory from
  * @return (void)
@@ -130,7 +207,7 @@ void free_list(dd_task_list_t *list) {
     dd_task_node_t *curr = list->head;
     while (curr != NULL) {
         dd_task_node_t *next = curr->next;
-        free(curr);
+        free_node(curr);
         curr = next;
     }
     list->head = NULL;
@@ -149,12 +226,303 @@ void print_list(dd_task_list_t *list, char * list_name) {
     dd_task_node_t *curr = list->head;
     printf("%s task list: (size: %d)\n", list_name, list->size);
 
-    printf("UserTID\tRelease\tDeadline\tCompletion\n");
+    printf(DD_TASK_LIST_HEADER);
     fflush(stdout);
     while (curr != NULL) {
-    	printf("\t%d\t\t%d\t\t%d\t\t\t%d\n", curr->task.user_task_id,curr->task.release_time, 
-            curr->task.absolute_deadline, curr->task.completion_time);
+    	printf(DD_TASK_LIST_ROW, curr->task.user_task_id, DD_TASK_TICKS_TO_MS(curr->task.release_time),
+            DD_TASK_TICKS_TO_MS(curr->task.absolute_deadline), DD_TASK_TICKS_TO_MS(curr->task.completion_time));
         curr = get_next(curr);
         fflush(stdout);
     }
 }
+
+/**
+ * @brief Return true if node a should be ahead of node b in the heap. Ties on
+ *        the deadline are broken by task id so equal deadlines are served in
+ *        release order, the same as push() does for the linked list. Both
+ *        are compared by difference, so the order holds across the wrap of
+ *        the tick count as long as the times are less than 2^31 apart.
+ *
+ * @param a (dd_task_node_t *) [IN] First node
+ * @param b (dd_task_node_t *) [IN] Second node
+ * @return (bool) true if a has the earlier deadline
+ */
+static bool heap_before(dd_task_node_t *a, dd_task_node_t *b) {
+    // Deadlines and ids wrap, so compare their difference
+    if (a->task.absolute_deadline != b->task.absolute_deadline) {
+        return (int32_t)(a->task.absolute_deadline - b->task.absolute_deadline) < 0;
+    }
+    return (int32_t)(a->task.task_id - b->task.task_id) < 0;
+}
+
+/**
+ * @brief Place a node in a heap slot and record the slot in the node
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap
+ * @param index (int) [IN] Slot to store the node in
+ * @param node (dd_task_node_t *) [IN] Node to store
+ * @return (void)
+ */
+static void heap_set(dd_task_heap_t *heap, int index, dd_task_node_t *node) {
+    heap->nodes[index] = node;
+    node->heap_index = index;
+}
+
+/**
+ * @brief Move the node at index towards the root until the heap order holds
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap
+ * @param index (int) [IN] Slot of the node to move
+ * @return (void)
+ */
+static void heap_sift_up(dd_task_heap_t *heap, int index) {
+    dd_task_node_t *node = heap->nodes[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!heap_before(node, heap->nodes[parent])) {
+            break;
+        }
+        heap_set(heap, index, heap->nodes[parent]);
+        index = parent;
+    }
+    heap_set(heap, index, node);
+}
+
+/**
+ * @brief Move the node at index towards the leaves until the heap order holds
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap
+ * @param index (int) [IN] Slot of the node to move
+ * @return (void)
+ */
+static void heap_sift_down(dd_task_heap_t *heap, int index) {
+    dd_task_node_t *node = heap->nodes[index];
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size && heap_before(heap->nodes[child + 1], heap->nodes[child])) {
+            child++;
+        }
+        if (!heap_before(heap->nodes[child], node)) {
+            break;
+        }
+        heap_set(heap, index, heap->nodes[child]);
+        index = child;
+    }
+    heap_set(heap, index, node);
+}
+
+/**
+ * @brief Add a node to the task_id index of the heap. Task ids are handed out
+ *        in increasing order, so the low bits of active ids rarely collide
+ *        and the first probe almost always hits an empty slot.
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap
+ * @param node (dd_task_node_t *) [IN] Node to index
+ * @return (void)
+ */
+static void index_insert(dd_task_heap_t *heap, dd_task_node_t *node) {
+    uint32_t slot = node->task.task_id & heap->index_mask;
+    while (heap->index[slot] != NULL) {
+        slot = (slot + 1) & heap->index_mask;
+    }
+    heap->index[slot] = node;
+}
+
+/**
+ * @brief Find the index slot holding a task id
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap
+ * @param task_id (uint32_t) [IN] The task id to find
+ * @return (int) The slot if found, -1 otherwise
+ */
+static int index_find(dd_task_heap_t *heap, uint32_t task_id) {
+    uint32_t slot = task_id & heap->index_mask;
+    while (heap->index[slot] != NULL) {
+        if (heap->index[slot]->task.task_id == task_id) {
+            return (int)slot;
+        }
+        slot = (slot + 1) & heap->index_mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Empty an index slot. Entries further along the probe chain are
+ *        shifted back so that lookups never stop early at the hole.
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap
+ * @param slot (uint32_t) [IN] The slot to empty
+ * @return (void)
+ */
+static void index_remove(dd_task_heap_t *heap, uint32_t slot) {
+    uint32_t next = slot;
+    heap->index[slot] = NULL;
+    for (;;) {
+        next = (next + 1) & heap->index_mask;
+        if (heap->index[next] == NULL) {
+            return;
+        }
+        uint32_t home = heap->index[next]->task.task_id & heap->index_mask;
+        // Distance from the home slot, the entry can only move back to the
+        // hole if that does not take it before its home slot
+        if (((next - home) & heap->index_mask) >= ((next - slot) & heap->index_mask)) {
+            heap->index[slot] = heap->index[next];
+            heap->index[next] = NULL;
+            slot = next;
+        }
+    }
+}
+
+/**
+ * @brief Initialize the heap
+ *
+ * @param heap (dd_task_heap_t *) [IN] Pointer to the heap
+ * @param storage (dd_task_node_t **) [IN] Array of capacity node pointers used to store the heap
+ * @param capacity (int) [IN] The number of tasks the heap can hold
+ * @param index (dd_task_node_t **) [IN] Array of index_size node pointers used for the task_id index
+ * @param index_size (int) [IN] A power of two larger than capacity, see DD_TASK_INDEX_SIZE()
+ */
+void init_task_heap(dd_task_heap_t *heap, dd_task_node_t **storage, int capacity,
+    dd_task_node_t **index, int index_size) {
+    heap->nodes = storage;
+    heap->capacity = capacity;
+    heap->size = 0;
+    heap->index = index;
+    heap->index_mask = index_size > 0 ? (uint32_t)index_size - 1 : 0;
+    for (int i = 0; i < index_size; i++) {
+        index[i] = NULL;
+    }
+}
+
+/**
+ * @brief Insert a task in the heap in O(log n)
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap to insert the task in
+ * @param task (dd_task_t) [IN] Task to be inserted
+ * @return (bool) true if the task was inserted, false if the heap is full or
+ *         the node pool is exhausted
+ */
+bool heap_push(dd_task_heap_t *heap, dd_task_t task) {
+    if (heap->size >= heap->capacity) {
+        return false;
+    }
+    dd_task_node_t *new_node = alloc_node();
+    if (new_node == NULL) {
+        return false;
+    }
+    new_node->task = task;
+    new_node->next = NULL;
+    index_insert(heap, new_node);
+    heap->nodes[heap->size] = new_node;
+    heap->size++;
+    heap_sift_up(heap, heap->size - 1);
+    return true;
+}
+
+/**
+ * @brief Return the node with the earliest deadline without removing it
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap
+ * @return (dd_task_node_t *) The earliest deadline node, NULL if the heap is empty
+ */
+dd_task_node_t *heap_peek(dd_task_heap_t *heap) {
+    if (heap->size == 0) {
+        return NULL;
+    }
+    return heap->nodes[0];
+}
+
+/**
+ * @brief Get the task object from the heap in O(1)
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap to get the task from
+ * @param task_id (uint32_t) [IN] The task id to get
+ * @return (dd_task_t*) The task object if found, NULL otherwise
+ */
+dd_task_t *heap_get_task(dd_task_heap_t *heap, uint32_t task_id) {
+    int slot = index_find(heap, task_id);
+    if (slot < 0) {
+        return NULL;
+    }
+    return &heap->index[slot]->task;
+}
+
+/**
+ * @brief remove a task from the heap by task id in O(log n)
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap to remove the task from
+ * @param task_id (uint32_t) [IN] The task id to remove
+ * @return (TaskHandle_t) The task handle of the removed task if found, NULL otherwise
+ * @note The node is returned to the node pool
+ */
+TaskHandle_t heap_remove_task(dd_task_heap_t *heap, uint32_t task_id) {
+    int slot = index_find(heap, task_id);
+    if (slot < 0) {
+        return NULL;
+    }
+    dd_task_node_t *node = heap->index[slot];
+    index_remove(heap, (uint32_t)slot);
+    int index = node->heap_index;
+    heap->size--;
+    if (index != heap->size) {
+        // Fill the hole with the last node and restore the heap order around it
+        heap_set(heap, index, heap->nodes[heap->size]);
+        if (index > 0 && heap_before(heap->nodes[index], heap->nodes[(index - 1) / 2])) {
+            heap_sift_up(heap, index);
+        } else {
+            heap_sift_down(heap, index);
+        }
+    }
+    TaskHandle_t t_handle = node->task.t_handle;
+    free_node(node);
+    return t_handle;
+}
+
+/**
+ * @brief Return the number of tasks in the heap
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap
+ * @return (int) The number of tasks in the heap
+ */
+int heap_size(dd_task_heap_t *heap) {
+    return heap->size;
+}
+
+/**
+ * @brief Return the heap nodes to the pool and set the size to 0
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap to free memory from
+ * @return (void)
+ */
+void free_heap(dd_task_heap_t *heap) {
+    for (int i = 0; i < heap->size; i++) {
+        free_node(heap->nodes[i]);
+    }
+    for (uint32_t i = 0; i <= heap->index_mask && heap->index != NULL; i++) {
+        heap->index[i] = NULL;
+    }
+    heap->size = 0;
+}
+
+/**
+ * @brief print items in the heap. Only the first entry is guaranteed to be
+ *       the earliest deadline, the rest are printed in heap order.
+ *
+ * @param heap (dd_task_heap_t *) [IN] The heap to print
+ * @return (void)
+ */
+void print_heap(dd_task_heap_t *heap, char * heap_name) {
+    printf("%s task list: (size: %d)\n", heap_name, heap->size);
+
+    printf(DD_TASK_LIST_HEADER);
+    fflush(stdout);
+    for (int i = 0; i < heap->size; i++) {
+        dd_task_node_t *curr = heap->nodes[i];
+    	printf(DD_TASK_LIST_ROW, curr->task.user_task_id, DD_TASK_TICKS_TO_MS(curr->task.release_time),
+            DD_TASK_TICKS_TO_MS(curr->task.absolute_deadline), DD_TASK_TICKS_TO_MS(curr->task.completion_time));
+        fflush(stdout);
+    }
+}
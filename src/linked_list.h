@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <time.h>
 #include <stdbool.h>
+
+#ifndef DD_HOST_BUILD
 #include "stm32f4_discovery.h"
 
 /* Kernel includes. */
@@ -16,6 +18,38 @@
 #include "../FreeRTOS_Source/include/semphr.h"
 #include "../FreeRTOS_Source/include/task.h"
 #include "../FreeRTOS_Source/include/timers.h"
+#else
+/* Host builds (see Makefile) only need an opaque task handle. */
+typedef void * TaskHandle_t;
+#endif
+
+/**
+ * @brief Number of dd_task_node_t in the static node pool shared by all lists
+ *        and heaps. Can be overridden at build time.
+ */
+#ifndef DD_TASK_POOL_SIZE
+#define DD_TASK_POOL_SIZE 256
+#endif
+
+/**
+ * @brief Column layout of a task list as printed by print_list(),
+ *        print_heap() and the monitor: the header line, and the format of
+ *        one task (user task id, release time, deadline, completion time).
+ *        The times are printed in ms, converted with DD_TASK_TICKS_TO_MS().
+ */
+#define DD_TASK_LIST_HEADER "UserTID  Release  Deadline  Completion\n"
+#define DD_TASK_LIST_ROW "%7u  %7u  %8u  %10u\n"
+
+/**
+ * @brief Convert a task time from ticks to ms for printing, in 64 bits so
+ *        the product does not overflow after 71 minutes. Host builds count
+ *        their time in ms already.
+ */
+#ifndef DD_HOST_BUILD
+#define DD_TASK_TICKS_TO_MS(ticks) ((unsigned)(((uint64_t)(ticks) * 1000) / configTICK_RATE_HZ))
+#else
+#define DD_TASK_TICKS_TO_MS(ticks) ((unsigned)(ticks))
+#endif
 
 /**
  * @brief Enumeration to determine if the task is a periodic or aperiodic task
@@ -35,9 +69,9 @@ typedef enum task_type {
  * @param (TaskHandle_t) t_handle The task handle
  * @param (uint32_t) task_id The task id
  * @param (task_type_t) type The task type (PERIODIC or APERIODIC)
- * @param (uint32_t) release_time The task release time in ms
- * @param (uint32_t) absolut_deadline The hard absolute deadline in ms
- * @param (uint32_t) completion_time The time it takes to complete the task in ms
+ * @param (uint32_t) release_time The task release time in ticks
+ * @param (uint32_t) absolut_deadline The hard absolute deadline in ticks
+ * @param (uint32_t) completion_time The tick the task completed at, 0 while active
  * @param (uint32_t) execution_time The amount of time that the task executes in ms
  */
 typedef struct dd_task {
@@ -55,10 +89,12 @@ typedef struct dd_task {
  * 
  * @param task (dd_task_t) The task to store in the node
  * @param next (dd_task_node_t *) Pointer to the next node in the linked list
+ * @param heap_index (int) Position of the node in a dd_task_heap_t, -1 if not in a heap
  */
 typedef struct dd_task_node {
     dd_task_t task;
     struct dd_task_node *next;
+    int heap_index;
 } dd_task_node_t;
 
 //Struct to hold pointer to the head of the linked list
@@ -74,11 +110,54 @@ typedef struct dd_task_list {
     int size;
 } dd_task_list_t;
 
+/**
+ * @brief Array backed binary min-heap of task nodes keyed on absolute_deadline.
+ *        The earliest deadline is always at nodes[0]. Nodes themselves stay at
+ *        a fixed address, so pointers to their task remain valid while the
+ *        heap is reordered. A hash index on the low bits of task_id gives
+ *        O(1) lookup by task id.
+ * 
+ * @param nodes (dd_task_node_t **) Storage for the heap, supplied by the owner
+ * @param capacity (int) The number of slots in nodes
+ * @param size (int) The number of tasks in the heap
+ * @param index (dd_task_node_t **) Open addressed task_id index, supplied by the owner
+ * @param index_mask (uint32_t) Number of slots in index minus one
+ */
+typedef struct dd_task_heap {
+    struct dd_task_node **nodes;
+    int capacity;
+    int size;
+    struct dd_task_node **index;
+    uint32_t index_mask;
+} dd_task_heap_t;
+
+/**
+ * @brief Number of index slots to allocate for a heap of the given capacity.
+ *        A power of two at least twice the capacity keeps probe chains short.
+ */
+#define DD_TASK_INDEX_SIZE(capacity) \
+    ((capacity) <= 8 ? 16 : (capacity) <= 32 ? 64 : (capacity) <= 128 ? 256 : \
+     (capacity) <= 512 ? 1024 : (capacity) <= 2048 ? 4096 : 8192)
+
+/**
+ * @brief Usage counters of the node pool
+ * 
+ * @param capacity (uint32_t) Number of nodes in the pool
+ * @param in_use (uint32_t) Number of nodes currently allocated
+ * @param high_water_mark (uint32_t) Largest number of nodes allocated at once
+ * @param exhausted_count (uint32_t) Number of allocations that failed because the pool was empty
+ */
+typedef struct dd_task_pool_stats {
+    uint32_t capacity;
+    uint32_t in_use;
+    uint32_t high_water_mark;
+    uint32_t exhausted_count;
+} dd_task_pool_stats_t;
 
 
 void init_task_list(dd_task_list_t *list);
 dd_task_node_t *get_head(dd_task_list_t *list);
-void push(dd_task_list_t *list, dd_task_t task);
+bool push(dd_task_list_t *list, dd_task_t task);
 dd_task_node_t *pop(dd_task_list_t *list);
 TaskHandle_t remove_task(dd_task_list_t *list, uint32_t task_id);
 dd_task_t *get_task(dd_task_list_t *list, uint32_t task_id);
@@ -86,5 +165,21 @@ void free_list(dd_task_list_t *list);
 void print_list(dd_task_list_t *list, char * list_name);
 dd_task_node_t *get_next(dd_task_node_t *node);
 
+void init_task_heap(dd_task_heap_t *heap, dd_task_node_t **storage, int capacity,
+    dd_task_node_t **index, int index_size);
+bool heap_push(dd_task_heap_t *heap, dd_task_t task);
+dd_task_node_t *heap_peek(dd_task_heap_t *heap);
+dd_task_t *heap_get_task(dd_task_heap_t *heap, uint32_t task_id);
+TaskHandle_t heap_remove_task(dd_task_heap_t *heap, uint32_t task_id);
+int heap_size(dd_task_heap_t *heap);
+void free_heap(dd_task_heap_t *heap);
+void print_heap(dd_task_heap_t *heap, char * heap_name);
+
+void get_task_pool_stats(dd_task_pool_stats_t *stats);
+
+/* Defined by the application, called when a node cannot be allocated
+because the pool is empty. */
+void vApplicationTaskPoolExhaustedHook(void);
+
 
 #endif
@@ -25,56 +25,169 @@
 #include "../FreeRTOS_Source/include/timers.h"
 
 #include "./linked_list.h"
+#include "./admission.h"
+#include "./tbs.h"
+#include "./release_ring.h"
+#include "./release_engine.h"
+#include "./sched_trace.h"
+#include "./cycle_stats.h"
+#include "./task_stats.h"
+#include "./task_history.h"
+#include "./task_snapshot.h"
+#include "./dd_log.h"
+#include "./uart_console.h"
+#include "./workload.h"
+#include "./task_sets.h"
 
 /*-----------------------------------------------------------*/
 #define mainQUEUE_LENGTH 100
+#define mainDDS_QUEUE_SET_LENGTH ( mainQUEUE_LENGTH + 2 )
+#define MAX_ACTIVE_DD_TASKS 100
 
-//#define TEST_BENCH_1 1
-//#define TEST_BENCH_2 2
-#define TEST_BENCH_3 3
-
-#ifdef TEST_BENCH_1
-	#define TASK1_PERIOD 500
-	#define TASK2_PERIOD 500
-	#define TASK3_PERIOD 750
-	#define TASK1_EXEC_TIME 95
-	#define TASK2_EXEC_TIME 150
-	#define TASK3_EXEC_TIME 250
+#if MAX_ACTIVE_DD_TASKS > DD_SNAPSHOT_MAX_ACTIVE
+#error "DD_SNAPSHOT_MAX_ACTIVE must hold every active task"
 #endif
 
-#ifdef TEST_BENCH_2
-	#define TASK1_PERIOD 250
-	#define TASK2_PERIOD 500
-	#define TASK3_PERIOD 750
-	#define TASK1_EXEC_TIME 95
-	#define TASK2_EXEC_TIME 150
-	#define TASK3_EXEC_TIME 250
+/* The monitor logs the lateness histogram of a task as one record. */
+#if TASK_STATS_LATENESS_BUCKETS != 8
+#error "Monitor_Task logs exactly 8 lateness buckets"
 #endif
 
-#ifdef TEST_BENCH_3
-	#define TASK1_PERIOD 500
-	#define TASK2_PERIOD 500
-	#define TASK3_PERIOD 500
-	#define TASK1_EXEC_TIME 100
-	#define TASK2_EXEC_TIME 200
-	#define TASK3_EXEC_TIME 200
+/* Set ADMISSION_ENFORCE to 0 to only count the task sets and jobs that fail
+the admission test instead of rejecting them. */
+#ifndef ADMISSION_ENFORCE
+#define ADMISSION_ENFORCE 1
 #endif
 
+/* Number of preallocated worker tasks that run DD-task jobs. It bounds the
+number of jobs that can be released and not yet completed or overdue. main()
+checks that it covers the admitted task set: a worker per job a periodic task
+can have active, APERIODIC_MAX_BURST per aperiodic task with a deadline, and
+one for the aperiodic server, which runs its jobs one at a time. */
+#ifndef DD_WORKER_POOL_SIZE
+#define DD_WORKER_POOL_SIZE 4
+#endif
+
+/* A worker that ran WORKLOAD_FPU is switched out with the extended frame of
+the Cortex-M4F, 50 words of registers instead of 17, on top of the calls of
+its job. The monitor reports the least headroom left by any worker. */
+#ifndef WORKER_STACK_SIZE
+#define WORKER_STACK_SIZE ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/* Aperiodic jobs are served by a Total Bandwidth Server of
+APERIODIC_SERVER_BANDWIDTH parts per million of the processor, 0 to turn it
+off. They arrive in bursts of up to APERIODIC_MAX_BURST jobs, and wait in
+their own release ring, of RELEASE_RING_SIZE jobs, until the server is free. */
+#ifndef APERIODIC_SERVER_BANDWIDTH
+#define APERIODIC_SERVER_BANDWIDTH 100000
+#endif
+#define APERIODIC_MAX_BURST 3
+
+/* Task set that is run, one of the test_bench_n tables below. */
+#ifndef TASK_SET
+#define TASK_SET test_bench_3
+#endif
+#define TASK_SET_SIZE ( sizeof( TASK_SET ) / sizeof( TASK_SET[0] ) )
+
 #define amber_led	LED3
 #define green_led	LED4
 #define red_led		LED5
+#define blue_led	LED6
 
-#define DDS_PRIORITY				( tskIDLE_PRIORITY + 3 )
+#define DDS_PRIORITY				( tskIDLE_PRIORITY + 4 )
 
 #define USER_ACTIVE_TASK_PRIORITY	( tskIDLE_PRIORITY + 2 )
 #define USER_IDLE_TASK_PRIORITY		( tskIDLE_PRIORITY + 0)
 
-#define MONITOR_ACTIVE_PRIORITY		( tskIDLE_PRIORITY + 5 )
+/* With native EDF scheduling every worker stays in the EDF band and the
+kernel runs the one with the earliest deadline. */
+#if ( configUSE_EDF_SCHEDULING == 1 )
+	#define USER_WORKER_PRIORITY	configEDF_PRIORITY
+#else
+	#define USER_WORKER_PRIORITY	USER_IDLE_TASK_PRIORITY
+#endif
+
+#define MONITOR_ACTIVE_PRIORITY		( tskIDLE_PRIORITY + 6 )
 #define MONITOR_IDLE_PRIORITY		( tskIDLE_PRIORITY + 0 )
 
+/* The log task runs above the workers, so the log drains however loaded the
+system is, but prints at most LOG_DRAIN_BATCH records every
+LOG_DRAIN_PERIOD_MS. The time it takes from the DD jobs is reserved in the
+admission control, before any periodic task is admitted, assuming a record
+takes at most LOG_DRAIN_RECORD_US to format and hand to the console: about
+100 characters through the ITM at a 4 Mbit/s SWO. A slower SWO, or longer
+records, need a larger LOG_DRAIN_RECORD_US. */
+#define LOG_PRIORITY				( tskIDLE_PRIORITY + 3 )
+#define LOG_DRAIN_PERIOD_MS			10
+#define LOG_DRAIN_BATCH				2
+#ifndef LOG_DRAIN_RECORD_US
+#define LOG_DRAIN_RECORD_US			250
+#endif
+#define LOG_DRAIN_BANDWIDTH_PPM		( LOG_DRAIN_BATCH * LOG_DRAIN_RECORD_US * 1000 / LOG_DRAIN_PERIOD_MS )
+/* printf keeps a TS_CHUNK_SIZE byte chunk on the stack of the log task and
+writes it out through the console, which may block in the kernel. The
+monitor reports how much of it was never used. */
+#define LOG_STACK_SIZE				( configMINIMAL_STACK_SIZE * 2 )
+/* The DDS calls into the release engine, the active task heap and the
+snapshot, and logs, from its own loop. The monitor report keeps a statistics
+struct per module on the stack, the cycle statistics with their histogram. */
+#define DDS_STACK_SIZE				( configMINIMAL_STACK_SIZE * 2 )
+#define MONITOR_STACK_SIZE			( configMINIMAL_STACK_SIZE * 2 )
+
+/* Buckets of a cycle histogram logged per record, two arguments each */
+#define CYCLE_BUCKETS_PER_RECORD	( DD_LOG_MAX_ARGS / 2 )
+
+
+#define pdTICKS_TO_MS( xTicks ) ( ( uint32_t ) ( ( ( uint64_t ) ( xTicks ) * ( uint64_t ) 1000 )  / ( uint64_t ) configTICK_RATE_HZ ) )
+
+
+/**
+ * @brief A worker task of the pool, and the job it is running
+ *
+ * @param t_handle (TaskHandle_t) Handle of the worker task
+ * @param job (dd_task_t) Copy of the DD-task being run
+ * @param busy (bool) Set by the DDS on dispatch, cleared by the DDS once the worker reported
+ * 		that the job returned
+ * @param cancelled (bool) Set by the DDS when the job is overdue, the job must return
+ */
+typedef struct dd_worker {
+	TaskHandle_t t_handle;
+	dd_task_t job;
+	volatile bool busy;
+	volatile bool cancelled;
+} dd_worker_t;
+
+struct dd_task_desc;
 
-#define pdTICKS_TO_MS( xTicks ) ( ( uint32_t ) ( ( ( uint32_t ) ( xTicks ) * ( uint32_t ) 1000 )  / ( uint32_t ) configTICK_RATE_HZ ) )
+/* Body of a DD-task job, run by a worker. It returns when done, or early when
+worker->cancelled is set. */
+typedef void (*dd_job_fn_t)( dd_worker_t *worker, const struct dd_task_desc *desc );
 
+/**
+ * @brief Entry of a task set table. The user_task_id of an entry is its index
+ * 		plus one. All times are in ms.
+ *
+ * @param type (task_type_t) PERIODIC, or APERIODIC for bursts of jobs at random times
+ * @param period (uint32_t) Period, or mean time between bursts for an aperiodic task
+ * @param execution_time (uint32_t) Worst case execution time
+ * @param relative_deadline (uint32_t) Relative deadline, 0 for the period, or for an
+ * 		aperiodic task to let the Total Bandwidth Server assign it
+ * @param phase (uint32_t) Time of the first release
+ * @param job (dd_job_fn_t) Function run for each job
+ * @param led (Led_TypeDef) LED lit while a job runs
+ * @param workload (workload_profile_t) Kind of work a job executes
+ */
+typedef struct dd_task_desc {
+	task_type_t type;
+	uint32_t period;
+	uint32_t execution_time;
+	uint32_t relative_deadline;
+	uint32_t phase;
+	dd_job_fn_t job;
+	Led_TypeDef led;
+	workload_profile_t workload;
+} dd_task_desc_t;
 
 /*
  * TODO: Implement this function for any hardware specific clock configuration
@@ -86,76 +199,175 @@ static void prvSetupHardware( void );
  * Function declarations.
  */
 void complete_dd_task( uint32_t task_id );
-dd_task_list_t get_active_dd_task_list(void);
-dd_task_list_t get_overdue_dd_task_list(void);
-dd_task_list_t get_completed_dd_task_list(void);
-void release_dd_task(enum task_type, uint32_t, uint32_t);
+void get_active_dd_task_list(dd_active_tasks_t *active_tasks);
+void get_overdue_dd_task_list(dd_task_history_t *overdue_task_history);
+void get_completed_dd_task_list(dd_task_history_t *completed_task_history);
+admission_result_t release_dd_task(enum task_type, uint32_t, uint32_t, uint32_t);
 
 /*
  * Task declarations.
  */
 static void DDS_Task( void * pvParameters );
+static bool handle_overdue_tasks( dd_task_heap_t *, dd_task_history_t * );
 void Task_Generator_Task( TimerHandle_t );
+static void Deadline_Timer_Callback( TimerHandle_t );
+static void signal_release( bool from_isr );
+static void release_periodic_job( uint32_t, uint32_t, uint32_t );
 static void Monitor_Task( void *pvParameters );
+static void log_monitor_report( void );
+static void Log_Task( void *pvParameters );
+
+static void Worker_Task( void *pvParameters );
+
+static void User_Defined_Task( dd_worker_t *worker, const dd_task_desc_t *desc );
+
+/*
+ * Task sets, kept in flash. TASK_SET selects the one that is run. The rows
+ * are in task_sets.h, which host/edf_sim.c simulates as well.
+ */
+
+#define DD_TASK_DESC( type, period, execution_time, relative_deadline, phase, led, workload ) \
+	{ type, period, execution_time, relative_deadline, phase, User_Defined_Task, led, workload },
+
+const dd_task_desc_t test_bench_1[] = { TEST_BENCH_1(DD_TASK_DESC) };
+const dd_task_desc_t test_bench_2[] = { TEST_BENCH_2(DD_TASK_DESC) };
+const dd_task_desc_t test_bench_3[] = { TEST_BENCH_3(DD_TASK_DESC) };
+const dd_task_desc_t test_bench_4[] = { TEST_BENCH_4(DD_TASK_DESC) };
 
-static void User_Defined_Task1( void *pvParameters );
-static void User_Defined_Task2( void *pvParameters );
-static void User_Defined_Task3( void *pvParameters );
+// User task ids are 1 to TASK_SET_SIZE, each needs its statistics
+_Static_assert(TASK_SET_SIZE <= TASK_STATS_MAX_TASKS, "TASK_STATS_MAX_TASKS must cover the task set");
 
 /*
  * Global handles.
  */
 
-xQueueHandle xQueue_new_dd_task = 0;
 xQueueHandle xQueue_completed_dd_task = 0;
-xQueueHandle xQueue_request_overdue_task_list = 0;
-xQueueHandle xQueue_request_completed_task_list = 0;
-xQueueHandle xQueue_request_active_task_list = 0;
-xQueueHandle xQueue_overdue_task_list = 0;
-xQueueHandle xQueue_completed_task_list = 0;
-xQueueHandle xQueue_active_task_list = 0;
-xTimerHandle xTimer_task1 = 0;
-xTimerHandle xTimer_task2 = 0;
-xTimerHandle xTimer_task3 = 0;
+QueueSetHandle_t xQueueSet_dds = 0;
+xTimerHandle xTimer_deadline = 0;
+xSemaphoreHandle deadline_expired = 0;
+xSemaphoreHandle release_pending = 0;
+release_ring_t release_ring;
+release_ring_t server_ring;
+dd_snapshot_t dd_snapshot;
+volatile bool release_signalled = false;
 xSemaphoreHandle monitor_task_lock = 0;
+TaskHandle_t promoted_t_handle = NULL;
+TaskHandle_t log_t_handle = NULL;
+TaskHandle_t dds_t_handle = NULL;
+dd_worker_t worker_pool[DD_WORKER_POOL_SIZE];
+bool server_busy = false;
+uint32_t server_task_id = 0;
+uint32_t aperiodic_rearm_failed = 0;
+// Reports the monitor did not log because the previous one was still printing
+uint32_t monitor_reports_skipped = 0;
+// Random arrivals of the aperiodic tasks, only drawn by the timer daemon
+static uint32_t arrival_random_state = 2463534242u;
 
 
 int main(void){
 	
 	prvSetupHardware();
 
-	STM_EVAL_LEDInit(amber_led);
-	STM_EVAL_LEDInit(red_led);
-	STM_EVAL_LEDInit(green_led);
+	for(int led = 0; led < LEDn; led++){
+		STM_EVAL_LEDInit((Led_TypeDef)led);
+	}
 
 	//Create queues
-	xQueue_new_dd_task = xQueueCreate(mainQUEUE_LENGTH, sizeof(dd_task_t));
 	xQueue_completed_dd_task = xQueueCreate(mainQUEUE_LENGTH, sizeof(uint32_t));
-	xQueue_request_overdue_task_list = xQueueCreate(mainQUEUE_LENGTH, sizeof(dd_task_list_t));
-	xQueue_request_completed_task_list = xQueueCreate(mainQUEUE_LENGTH, sizeof(dd_task_list_t));
-	xQueue_request_active_task_list = xQueueCreate(mainQUEUE_LENGTH, sizeof(dd_task_list_t));
-	xQueue_overdue_task_list = xQueueCreate(mainQUEUE_LENGTH, sizeof(dd_task_list_t));
-	xQueue_completed_task_list = xQueueCreate(mainQUEUE_LENGTH, sizeof(dd_task_list_t));
-	xQueue_active_task_list = xQueueCreate(mainQUEUE_LENGTH, sizeof(dd_task_list_t));
-	vQueueAddToRegistry(xQueue_new_dd_task, "NewDDTaskQueue");
 	vQueueAddToRegistry(xQueue_completed_dd_task, "CompletedDDTaskQueue");
-	vQueueAddToRegistry(xQueue_overdue_task_list, "OverdueTaskListQueue");
-	vQueueAddToRegistry(xQueue_completed_task_list, "CompletedTaskListQueue");
-	vQueueAddToRegistry(xQueue_active_task_list, "ActiveTaskListQueue");
-	vQueueAddToRegistry(xQueue_request_active_task_list, "RequestActiveTaskListQueue");
-	vQueueAddToRegistry(xQueue_request_overdue_task_list, "RequestOverdueTaskListQueue");
-	vQueueAddToRegistry(xQueue_request_completed_task_list, "RequestCompletedTaskListQueue");
-
-	xTaskCreate(DDS_Task, "DDS_Task", configMINIMAL_STACK_SIZE, NULL, DDS_PRIORITY, NULL);
-
-	//Create timers
-	xTimer_task1 = xTimerCreate("Task 1 Timer", 1, pdTRUE, NULL, Task_Generator_Task);
-	xTimer_task2 = xTimerCreate("Task 2 Timer", 1, pdTRUE, NULL, Task_Generator_Task);
-	xTimer_task3 = xTimerCreate("Task 3 Timer", 1, pdTRUE, NULL, Task_Generator_Task);
-	// Start timers
-	xTimerStart(xTimer_task1, 0);
-	xTimerStart(xTimer_task2, 0);
-	xTimerStart(xTimer_task3, 0);
+
+	// The DDS publishes the task lists here, readers never wait on it
+	init_snapshot(&dd_snapshot);
+
+	// One-shot timer armed at the earliest active deadline
+	xTimer_deadline = xTimerCreate("Deadline Timer", 1, pdFALSE, NULL, Deadline_Timer_Callback);
+	deadline_expired = xSemaphoreCreateBinary();
+
+	// Releases go through a wait-free ring, the semaphore wakes the DDS
+	init_release_ring(&release_ring);
+	init_release_ring(&server_ring);
+	release_pending = xSemaphoreCreateBinary();
+
+	init_sched_trace();
+	init_cycle_stats();
+	init_dd_log();
+	init_workload();
+
+	// The DDS blocks on one queue set covering every queue it receives from
+	xQueueSet_dds = xQueueCreateSet(mainDDS_QUEUE_SET_LENGTH);
+	xQueueAddToSet(deadline_expired, xQueueSet_dds);
+	xQueueAddToSet(release_pending, xQueueSet_dds);
+	xQueueAddToSet(xQueue_completed_dd_task, xQueueSet_dds);
+
+	xTaskCreate(DDS_Task, "DDS_Task", DDS_STACK_SIZE, NULL, DDS_PRIORITY, &dds_t_handle);
+	xTaskCreate(Log_Task, "Log_Task", LOG_STACK_SIZE, NULL, LOG_PRIORITY, &log_t_handle);
+
+	// Create the worker pool once, jobs are dispatched to idle workers
+	for(int i = 0; i < DD_WORKER_POOL_SIZE; i++){
+		worker_pool[i].busy = false;
+		worker_pool[i].cancelled = false;
+		xTaskCreate(Worker_Task, "Worker", WORKER_STACK_SIZE, &worker_pool[i], USER_WORKER_PRIORITY, &worker_pool[i].t_handle);
+	}
+
+	// The log task runs above the DD jobs, its budget comes first
+	admission_result_t log_admission = admit_reservation(LOG_DRAIN_BANDWIDTH_PPM);
+	configASSERT(log_admission == ADMISSION_ACCEPTED);
+	( void ) log_admission;
+
+	// Give the periodic tasks that pass the admission test to the release
+	// engine, started by the DDS. Each needs a worker per job it can have
+	// active, more than one if its deadline is past its period.
+	uint32_t workers_needed = 0;
+	for(uint32_t i = 0; i < TASK_SET_SIZE; i++){
+		const dd_task_desc_t *desc = &TASK_SET[i];
+		if(desc->type != PERIODIC){
+			continue;
+		}
+		bool admitted = admit_periodic_task(i + 1, pdMS_TO_TICKS(desc->period),
+				pdMS_TO_TICKS(desc->execution_time), pdMS_TO_TICKS(desc->relative_deadline)) == ADMISSION_ACCEPTED;
+		if(!admitted){
+			dd_log("Admission: periodic task %u (C = %u ms, T = %u ms) rejected%s\n", i + 1,
+					desc->execution_time, desc->period, ADMISSION_ENFORCE ? "" : ", run anyway");
+		}
+		if(admitted || !ADMISSION_ENFORCE){
+			release_engine_add_task(i + 1, desc->period, desc->execution_time, desc->relative_deadline, desc->phase);
+			uint32_t relative_deadline = desc->relative_deadline != 0 ? desc->relative_deadline : desc->period;
+			workers_needed += (relative_deadline + desc->period - 1) / desc->period;
+		}
+	}
+	// Reserve the aperiodic server bandwidth next to the admitted tasks,
+	// only for a set with aperiodic tasks that have no deadline of their own
+	bool server_needed = false;
+	for(uint32_t i = 0; i < TASK_SET_SIZE; i++){
+		server_needed |= TASK_SET[i].type == APERIODIC && TASK_SET[i].relative_deadline == 0;
+	}
+	bool server_on = false;
+	bool server_admitted = APERIODIC_SERVER_BANDWIDTH > 0 && server_needed
+			&& admit_server(APERIODIC_SERVER_BANDWIDTH) == ADMISSION_ACCEPTED;
+	if(APERIODIC_SERVER_BANDWIDTH > 0 && server_needed && !server_admitted){
+		dd_log("Admission: aperiodic server (U_s = %u ppm) rejected%s\n", APERIODIC_SERVER_BANDWIDTH,
+				ADMISSION_ENFORCE ? "" : ", run anyway");
+	}
+	if(APERIODIC_SERVER_BANDWIDTH > 0 && server_needed && (server_admitted || !ADMISSION_ENFORCE)){
+		tbs_init(APERIODIC_SERVER_BANDWIDTH);
+		server_on = true;
+		workers_needed++;
+	}
+	// One timer per aperiodic task, its id is the table index. It reloads
+	// itself, so it keeps its last interval if a re-arm is not queued.
+	// Server jobs are only released while the server is on.
+	for(uint32_t i = 0; i < TASK_SET_SIZE; i++){
+		const dd_task_desc_t *desc = &TASK_SET[i];
+		if(desc->type == APERIODIC && (desc->relative_deadline != 0 || server_on)){
+			TimerHandle_t xTimer = xTimerCreate("Aperiodic Timer", pdMS_TO_TICKS(desc->phase) + 1, pdTRUE, (void *)(uintptr_t)i, Task_Generator_Task);
+			xTimerStart(xTimer, 0);
+			if(desc->relative_deadline != 0){
+				workers_needed += APERIODIC_MAX_BURST;
+			}
+		}
+	}
+	// Releases of the admitted set must never find every worker busy
+	configASSERT(workers_needed <= DD_WORKER_POOL_SIZE);
 
 	monitor_task_lock = xSemaphoreCreateBinary();
 	xSemaphoreGive(monitor_task_lock);
@@ -166,27 +378,292 @@ int main(void){
 }
 
 /**
- * @brief Function changes priority of task with earliest deadline to the
- * 		highest priority so that it can be executed.
+ * @brief Add a task to a history (completed or overdue). The history keeps
+ * 		the last DD_TASK_HISTORY_SIZE tasks and uses no pool nodes, so the
+ * 		active tasks always have the whole pool.
  *
- * @param active_task_list (dd_task_list_t *) [in] List of active tasks.
+ * @param history (dd_task_history_t *) [in] Completed or overdue task history.
+ * @param task (dd_task_t *) [in] Task to record.
  * @return void
  */
-void update_priorities(dd_task_list_t *active_task_list) {
-	if(active_task_list->size == 0) {
-		return;
+static void push_history(dd_task_history_t *history, const dd_task_t *task) {
+	uint32_t cycles_start;
+	cycle_stats_begin(cycles_start);
+	history_push(history, task);
+	cycle_stats_end(CYCLE_OP_HISTORY_PUSH, cycles_start);
+}
+
+/**
+ * @brief Arm the deadline timer to expire just after the earliest active
+ * 		deadline. The timer is only touched when the earliest deadline
+ * 		changes, so most releases and completions cost no kernel call here.
+ *
+ * @param active_task_list (dd_task_heap_t *) [in] Heap of active tasks.
+ * @return (bool) false if the timer command could not be queued, the timer is
+ * 		then left disarmed and the DDS must call again.
+ */
+static bool update_deadline_timer(dd_task_heap_t *active_task_list) {
+	static bool armed = false;
+	static TickType_t armed_deadline = 0;
+
+	if(heap_size(active_task_list) == 0) {
+		if(armed) {
+			// A stop that is not queued only lets the timer expire for
+			// nothing, the DDS then finds no overdue task
+			xTimerStop(xTimer_deadline, 0);
+			armed = false;
+		}
+		return true;
+	}
+	TickType_t deadline = heap_peek(active_task_list)->task.absolute_deadline;
+	if(armed && deadline == armed_deadline) {
+		return true;
+	}
+	TickType_t now = xTaskGetTickCount();
+	// Ticks wrap, so compare the difference
+	if((int32_t)(now - deadline) > 0) {
+		// Already late, no need to go through the timer
+		xSemaphoreGive(deadline_expired);
+		armed = false;
+		return true;
 	}
-	dd_task_node_t *head = get_head(active_task_list);
-	vTaskPrioritySet(head->task.t_handle, USER_ACTIVE_TASK_PRIORITY);
-	if(active_task_list->size == 1) {
+	// A task is overdue once the tick count is past its deadline. The timer
+	// queue may be full, the timer daemon then has not seen the command.
+	armed = xTimerChangePeriod(xTimer_deadline, deadline - now + 1, 0) == pdPASS;
+	armed_deadline = deadline;
+	return armed;
+}
+
+/**
+ * @brief Trace the job that becomes the earliest deadline, and the job it
+ * 		displaced if that one is still active.
+ *
+ * @param active_task_list (dd_task_heap_t *) [in] Heap of active tasks.
+ * @return void
+ */
+static void trace_earliest_deadline(dd_task_heap_t *active_task_list) {
+#if ( SCHED_TRACE_ENABLE == 1 )
+	static bool traced = false;
+	static uint32_t traced_task_id = 0;
+	static uint32_t traced_user_task_id = 0;
+
+	dd_task_node_t *head = heap_peek(active_task_list);
+	if(head != NULL && traced && head->task.task_id == traced_task_id) {
 		return;
 	}
-	dd_task_node_t *curr = get_next(head);
-	do {
-		//Set other priorities to idle priority
-		vTaskPrioritySet(curr->task.t_handle, USER_IDLE_TASK_PRIORITY);
-		curr = get_next(curr);
-	} while(curr != NULL);
+	if(traced && heap_get_task(active_task_list, traced_task_id) != NULL) {
+		sched_trace(SCHED_TRACE_PREEMPT, traced_task_id, traced_user_task_id);
+	}
+	traced = head != NULL;
+	if(head != NULL) {
+		traced_task_id = head->task.task_id;
+		traced_user_task_id = head->task.user_task_id;
+		sched_trace(SCHED_TRACE_DISPATCH, traced_task_id, traced_user_task_id);
+	}
+#else
+	( void ) active_task_list;
+#endif
+}
+
+/**
+ * @brief Function changes priority of task with earliest deadline to the
+ * 		highest priority so that it can be executed. Every other user task
+ * 		is created at, and stays at, idle priority, so only the previously
+ * 		promoted task and the new head are touched, and nothing is done
+ * 		when the head did not change.
+ *
+ * @param active_task_list (dd_task_heap_t *) [in] Heap of active tasks.
+ * @return void
+ */
+void update_priorities(dd_task_heap_t *active_task_list) {
+	uint32_t cycles_start;
+	cycle_stats_begin(cycles_start);
+	trace_earliest_deadline(active_task_list);
+#if ( configUSE_EDF_SCHEDULING == 1 )
+	// The kernel runs the earliest deadline worker by itself
+	( void ) active_task_list;
+#else
+	TaskHandle_t head_t_handle = NULL;
+	if(heap_size(active_task_list) > 0) {
+		head_t_handle = heap_peek(active_task_list)->task.t_handle;
+	}
+	if(head_t_handle != promoted_t_handle) {
+		if(promoted_t_handle != NULL) {
+			vTaskPrioritySet(promoted_t_handle, USER_IDLE_TASK_PRIORITY);
+		}
+		if(head_t_handle != NULL) {
+			vTaskPrioritySet(head_t_handle, USER_ACTIVE_TASK_PRIORITY);
+		}
+		promoted_t_handle = head_t_handle;
+	}
+#endif
+	cycle_stats_end(CYCLE_OP_UPDATE_PRIORITIES, cycles_start);
+}
+
+/**
+ * @brief Find a worker of the pool that is not running a job
+ *
+ * @return (dd_worker_t *) An idle worker, NULL if every worker is busy.
+ */
+static dd_worker_t *get_idle_worker(void) {
+	for(int i = 0; i < DD_WORKER_POOL_SIZE; i++) {
+		if(!worker_pool[i].busy) {
+			return &worker_pool[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Give a released job to an idle worker and add it to the active
+ * 		tasks. The job gets the next task id, it is traced with the id it
+ * 		would have had if no worker or active slot is free.
+ *
+ * @param active_task_list (dd_task_heap_t *) [in] Heap of active tasks.
+ * @param new_task (dd_task_t *) [in] The released job, its task id is set here.
+ * @param task_id_cnt (uint32_t *) [in] Next task id, incremented if the job was dispatched.
+ * @return (static bool) false if the job could not be dispatched.
+ */
+static bool dispatch_job(dd_task_heap_t *active_task_list, dd_task_t *new_task, uint32_t *task_id_cnt) {
+	uint32_t cycles_start;
+	new_task->task_id = *task_id_cnt;
+	dd_worker_t *worker = get_idle_worker();
+	if(worker == NULL){
+		return false;
+	}
+	new_task->t_handle = worker->t_handle;
+	cycle_stats_begin(cycles_start);
+	bool pushed = heap_push(active_task_list, *new_task);
+	cycle_stats_end(CYCLE_OP_HEAP_PUSH, cycles_start);
+	if(!pushed){
+		return false;
+	}
+	// Hand the job to the worker, it starts at idle priority
+	worker->job = *new_task;
+	worker->cancelled = false;
+	worker->busy = true;
+#if ( configUSE_EDF_SCHEDULING == 1 )
+	vTaskSetDeadline(worker->t_handle, new_task->absolute_deadline);
+#endif
+	sched_trace(SCHED_TRACE_RELEASE, new_task->task_id, new_task->user_task_id);
+	xTaskNotifyGive(worker->t_handle);
+	(*task_id_cnt)++;
+	return true;
+}
+
+/**
+ * @brief Count a released job that could not be dispatched. The job is lost,
+ * 		so it counts as a miss of its user task.
+ *
+ * @param task (dd_task_t *) [in] The dropped job.
+ * @param server_job (bool) [in] Whether the job came from the aperiodic server.
+ * @return void
+ */
+static void drop_job(const dd_task_t *task, bool server_job) {
+	sched_trace(SCHED_TRACE_DROP, task->task_id, task->user_task_id);
+	task_stats_record_drop(task->user_task_id);
+	if(server_job){
+		tbs_record_overdue();
+	}
+	admission_record_drop();
+}
+
+/**
+ * @brief Take back the worker of a job that returned, completed or
+ * 		cancelled. The DDS demotes it and marks it idle, so the worker can be
+ * 		given its next job as soon as it reported, before it ran again.
+ *
+ * @param task_id (uint32_t) [in] Task id of the job the worker ran.
+ * @return void
+ */
+static void return_worker(uint32_t task_id) {
+	for(int i = 0; i < DD_WORKER_POOL_SIZE; i++) {
+		if(worker_pool[i].busy && worker_pool[i].job.task_id == task_id) {
+#if ( configUSE_EDF_SCHEDULING == 1 )
+			vTaskSetDeadline(worker_pool[i].t_handle, portMAX_DELAY);
+#else
+			vTaskPrioritySet(worker_pool[i].t_handle, USER_IDLE_TASK_PRIORITY);
+#endif
+			worker_pool[i].busy = false;
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Start the next aperiodic server job if the server is free. The
+ * 		server runs one job at a time, so a burst waits in server_ring
+ * 		instead of taking the workers of the periodic jobs. Its jobs were
+ * 		given their deadline in arrival order, so the ring is in deadline
+ * 		order.
+ *
+ * @param active_task_list (dd_task_heap_t *) [in] Heap of active tasks.
+ * @param task_id_cnt (uint32_t *) [in] Next task id.
+ * @return (static bool) true if a job was dispatched or dropped.
+ */
+static bool dispatch_server_job(dd_task_heap_t *active_task_list, uint32_t *task_id_cnt) {
+	dd_task_t server_task;
+	if(server_busy || get_idle_worker() == NULL || !release_ring_pop(&server_ring, &server_task)){
+		return false;
+	}
+	if(dispatch_job(active_task_list, &server_task, task_id_cnt)){
+		server_busy = true;
+		server_task_id = server_task.task_id;
+	} else {
+		drop_job(&server_task, true);
+	}
+	return true;
+}
+
+/**
+ * @brief Free the aperiodic server if a job that left the active tasks was
+ * 		its job.
+ *
+ * @param task_id (uint32_t) [in] Task id of the job.
+ * @return (static bool) true if it was the server job.
+ */
+static bool end_server_job(uint32_t task_id) {
+	if(!server_busy || task_id != server_task_id){
+		return false;
+	}
+	server_busy = false;
+	return true;
+}
+
+/**
+ * @brief Stop the job of an overdue task. The worker is raised to the active
+ * 		priority (or the earliest deadline) so it notices the cancellation at
+ * 		once, it resets itself when the job has returned.
+ *
+ * @param t_handle (TaskHandle_t) [in] Handle of the worker running the overdue task.
+ * @return void
+ */
+static void cancel_worker_job(TaskHandle_t t_handle) {
+	for(int i = 0; i < DD_WORKER_POOL_SIZE; i++) {
+		if(worker_pool[i].t_handle == t_handle && worker_pool[i].busy) {
+			worker_pool[i].cancelled = true;
+#if ( configUSE_EDF_SCHEDULING == 1 )
+			vTaskSetDeadline(t_handle, 0);
+#else
+			vTaskPrioritySet(t_handle, USER_ACTIVE_TASK_PRIORITY);
+#endif
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Forget the promoted task if it is leaving the active list, so that
+ * 		update_priorities() does not demote a task that completed or was
+ * 		deleted.
+ *
+ * @param t_handle (TaskHandle_t) [in] Handle of the task leaving the active list.
+ * @return void
+ */
+static void clear_promoted_task(TaskHandle_t t_handle) {
+	if(t_handle == promoted_t_handle) {
+		promoted_t_handle = NULL;
+	}
 }
 
 
@@ -201,10 +678,18 @@ void upgrade_monitor_task_priority(TaskHandle_t monitor_t_handle){
 /**
  * @brief This task is responsible for creating user defined tasks,
  * 		  and adding them to the active task list. It runs in an infinite
- * 		  loop, and receives values when a new task is created, or when it
- * 		  is completed. 
+ * 		  loop, blocked on a queue set until a task is released, a task
+ * 		  completes, or the deadline timer armed at the earliest deadline
+ * 		  expires.
+ * 		  Aperiodic server jobs wait on server_ring and are dispatched one
+ * 		  at a time, whenever the previous one left the active tasks.
  * 		  Internally, it keeps track of which tasks are active, completed,
- * 		  and overdue, based on an internal linked list structure.
+ * 		  and overdue. Active tasks are kept in a min-heap ordered by
+ * 		  deadline, completed and overdue tasks in circular histories. Each
+ * 		  event is handled inside a write of dd_snapshot, which holds the
+ * 		  histories for the readers. The active tasks are only copied into
+ * 		  it when the monitor is woken, so a release or a completion does
+ * 		  not cost a copy of the whole heap.
  * 
  * @param pvParameters (void *) [in] Unused, should be NULL.
  * @return (static void) Does not return.
@@ -213,184 +698,225 @@ static void DDS_Task( void *pvParameters )
 {
 	dd_task_t new_task;
 	uint32_t completed_task_id;
-	dd_task_list_t active_task_list;
-	init_task_list(&active_task_list);
-	dd_task_list_t completed_task_list;
-	init_task_list(&completed_task_list);
-	dd_task_list_t overdue_task_list;
-	init_task_list(&overdue_task_list);
-	dd_task_list_t tmp_buffer;
-	init_task_list(&tmp_buffer);
+	static dd_task_node_t *active_task_storage[MAX_ACTIVE_DD_TASKS];
+	static dd_task_node_t *active_task_index[DD_TASK_INDEX_SIZE(MAX_ACTIVE_DD_TASKS)];
+	dd_task_heap_t active_task_list;
+	init_task_heap(&active_task_list, active_task_storage, MAX_ACTIVE_DD_TASKS,
+			active_task_index, DD_TASK_INDEX_SIZE(MAX_ACTIVE_DD_TASKS));
 	uint32_t task_id_cnt = 0;
 	TaskHandle_t monitor_t_handle = NULL;
+	uint32_t cycles_start;
+	TickType_t event_wait = portMAX_DELAY;
+
+	// Periodic releases start once there is someone to take them
+	release_engine_start(release_periodic_job);
 
 	for(;;){
-		if(xQueueReceive(xQueue_new_dd_task, &new_task, 0)){ //New task received
-			// Set unique task ID
-			new_task.task_id = task_id_cnt;
-			// Add new task to active task list and sort by deadline
-			push(&active_task_list, new_task);
-			dd_task_t *task_list_task = get_task(&active_task_list, new_task.task_id);
-			// Create new task in FreeRTOS
-			if(task_list_task->user_task_id == 1) {
-				xTaskCreate(User_Defined_Task1, "User_Defined_Task1",
-								configMINIMAL_STACK_SIZE, task_list_task, USER_IDLE_TASK_PRIORITY, &(task_list_task->t_handle));
-			} else if(task_list_task->user_task_id == 2) {
-				xTaskCreate(User_Defined_Task2, "User_Defined_Task2",
-								configMINIMAL_STACK_SIZE, task_list_task, USER_IDLE_TASK_PRIORITY , &(task_list_task->t_handle));
-			} else if(task_list_task->user_task_id == 3) {
-				xTaskCreate(User_Defined_Task3, "User_Defined_Task3",
-								configMINIMAL_STACK_SIZE, task_list_task, USER_IDLE_TASK_PRIORITY, &(task_list_task->t_handle));
-			}else{
-				// Aperiodic task
+		// Sleep until a message arrives or the deadline timer expires, or
+		// for a tick when the deadline timer could not be armed
+		QueueSetMemberHandle_t event = xQueueSelectFromSet(xQueueSet_dds, event_wait);
+		sched_trace(SCHED_TRACE_DDS_BEGIN, 0, 0);
+		snapshot_write_begin(&dd_snapshot);
+		bool wake_monitor = false;
+
+		if(event == release_pending && xSemaphoreTake(release_pending, 0)){ //New tasks released
+			// Clear the flag before draining, a release pushed after the
+			// last pop signals again
+			release_signalled = false;
+			while(release_ring_pop(&release_ring, &new_task)){
+				// The release is dropped if every worker is busy or the
+				// active task list is full
+				if(!dispatch_job(&active_task_list, &new_task, &task_id_cnt)){
+					drop_job(&new_task, false);
+				}
 			}
-			// Add release time to dd_task
-			task_list_task->release_time = pdMS_TO_TICKS(xTaskGetTickCount());
-			// Update task priorities in FreeRTOS to reflect EDF sorting
-			update_priorities(&active_task_list);
-
-			task_id_cnt++;
-		}
-		if(xQueueReceive(xQueue_completed_dd_task, &completed_task_id, 0)){ //Task completed
-			dd_task_t *completed_task = get_task(&active_task_list, completed_task_id);
-			// Remove task from active task list
-			remove_task(&active_task_list, completed_task_id);
-			// Add task to completed list
-			push(&completed_task_list, *completed_task);
-			// Add completion time to dd_task struct
-			completed_task->completion_time = pdTICKS_TO_MS(xTaskGetTickCount());
+			// Server jobs are released on server_ring and signal the same way
+			dispatch_server_job(&active_task_list, &task_id_cnt);
 			// Update task priorities in FreeRTOS to reflect EDF sorting
 			update_priorities(&active_task_list);
-
-			if(xSemaphoreTake(monitor_task_lock, 0)){
-				if(!monitor_t_handle){
-					xTaskCreate(Monitor_Task, "Monitor_Task", configMINIMAL_STACK_SIZE, NULL, MONITOR_IDLE_PRIORITY, &monitor_t_handle);
+		} else if(event == xQueue_completed_dd_task && xQueueReceive(xQueue_completed_dd_task, &completed_task_id, 0)){ //Task completed
+			// A cancelled job reports as well, it is no longer active
+			dd_task_t *completed_task = heap_get_task(&active_task_list, completed_task_id);
+			if(completed_task != NULL){
+				// Add completion time to dd_task struct, in ticks like the release
+				completed_task->completion_time = xTaskGetTickCount();
+				if(end_server_job(completed_task_id)){
+					tbs_record_completion(xTaskGetTickCount() - completed_task->release_time);
 				}
-				upgrade_monitor_task_priority(monitor_t_handle);
+				task_stats_record_completion(completed_task->user_task_id, completed_task->release_time,
+						completed_task->absolute_deadline, xTaskGetTickCount());
+				// Add task to completed list
+				push_history(&dd_snapshot.completed, completed_task);
+				// Remove task from active task list
+				cycle_stats_begin(cycles_start);
+				TaskHandle_t completed_t_handle = heap_remove_task(&active_task_list, completed_task_id);
+				cycle_stats_end(CYCLE_OP_HEAP_REMOVE, cycles_start);
+				clear_promoted_task(completed_t_handle);
+				wake_monitor = true;
 			}
-		}
-		//Check if any tasks are overdue
-		if(active_task_list.size > 0){
-			dd_task_node_t *head = get_head(&active_task_list);
-			if(xTaskGetTickCount() > head->task.absolute_deadline){ // Task is overdue
-				//Add task to overdue list
-				push(&overdue_task_list, head->task);
-				//Remove task from active task list
-				TaskHandle_t overdue_t_handle = remove_task(&active_task_list, head->task.task_id);
+			// The worker can take the next job right away
+			return_worker(completed_task_id);
+			dispatch_server_job(&active_task_list, &task_id_cnt);
+			// Update task priorities in FreeRTOS to reflect EDF sorting
+			update_priorities(&active_task_list);
+		} else if(event == deadline_expired && xSemaphoreTake(deadline_expired, 0)){ //Earliest deadline passed
+			//Move every task whose deadline has passed to the overdue list
+			cycle_stats_begin(cycles_start);
+			wake_monitor = handle_overdue_tasks(&active_task_list, &dd_snapshot.overdue);
+			cycle_stats_end(CYCLE_OP_OVERDUE, cycles_start);
+			// A cancelled server job frees the server, not yet its worker
+			if(dispatch_server_job(&active_task_list, &task_id_cnt)){
 				update_priorities(&active_task_list);
-				//Delete task from FreeRTOS
-				vTaskDelete(overdue_t_handle);
-				
-				STM_EVAL_LEDOff(amber_led);
-				STM_EVAL_LEDOff(red_led);
-				STM_EVAL_LEDOff(green_led);
-
-				if(xSemaphoreTake(monitor_task_lock, 0)){
-					if(!monitor_t_handle){
-						xTaskCreate(Monitor_Task, "Monitor_Task", configMINIMAL_STACK_SIZE, NULL, MONITOR_IDLE_PRIORITY, &monitor_t_handle);
-					}
-					upgrade_monitor_task_priority(monitor_t_handle);
-				}
 			}
 		}
-		if(xQueueReceive(xQueue_request_active_task_list, &tmp_buffer, 0)){ //Active task list requested
-			xQueueSend(xQueue_active_task_list, &active_task_list, 500);
+
+		// Follow the new earliest deadline, if it changed, and retry on the
+		// next tick if the timer queue was full
+		cycle_stats_begin(cycles_start);
+		event_wait = update_deadline_timer(&active_task_list) ? portMAX_DELAY : 1;
+		cycle_stats_end(CYCLE_OP_DEADLINE_TIMER, cycles_start);
+
+		// Publish the active tasks along with the histories, only for a
+		// report, so at most once per monitor run
+		bool report = wake_monitor && xSemaphoreTake(monitor_task_lock, 0);
+		cycle_stats_begin(cycles_start);
+		if(report){
+			snapshot_set_active(&dd_snapshot, &active_task_list);
+		}
+		snapshot_write_end(&dd_snapshot);
+		cycle_stats_end(CYCLE_OP_SNAPSHOT, cycles_start);
+
+		// Report once the snapshot is consistent, the monitor runs above the DDS
+		if(report){
+			if(!monitor_t_handle){
+				cycle_stats_begin(cycles_start);
+				xTaskCreate(Monitor_Task, "Monitor_Task", MONITOR_STACK_SIZE, NULL, MONITOR_IDLE_PRIORITY, &monitor_t_handle);
+				cycle_stats_end(CYCLE_OP_MONITOR_CREATE, cycles_start);
+			}
+			upgrade_monitor_task_priority(monitor_t_handle);
 		}
-		if(xQueueReceive(xQueue_request_completed_task_list, &tmp_buffer, 0)){ //Completed task list requested
-			xQueueSend(xQueue_completed_task_list, &completed_task_list, 500);
+		sched_trace(SCHED_TRACE_DDS_END, 0, 0);
+	}
+}
+
+/**
+ * @brief Move every active task whose deadline has passed to the overdue
+ * 		history and cancel its job. Called by the DDS when the
+ * 		deadline timer expires, so simultaneous misses are handled in a
+ * 		single pass.
+ *
+ * @param active_task_list (dd_task_heap_t *) [in] Heap of active tasks.
+ * @param overdue_task_history (dd_task_history_t *) [in] History of overdue tasks.
+ * @return (bool) true if any task was overdue.
+ */
+static bool handle_overdue_tasks(dd_task_heap_t *active_task_list, dd_task_history_t *overdue_task_history) {
+	bool missed = false;
+	while(heap_size(active_task_list) > 0){
+		dd_task_node_t *head = heap_peek(active_task_list);
+		if((int32_t)(xTaskGetTickCount() - head->task.absolute_deadline) <= 0){ // Earliest task is not overdue
+			break;
 		}
-		if(xQueueReceive(xQueue_request_overdue_task_list, &tmp_buffer, 0)){ //Overdue task list requested
-			xQueueSend(xQueue_overdue_task_list, &overdue_task_list, 500);
+		if(end_server_job(head->task.task_id)){
+			tbs_record_overdue();
 		}
-		vTaskDelay(1);
+		sched_trace(SCHED_TRACE_OVERDUE, head->task.task_id, head->task.user_task_id);
+		task_stats_record_overdue(head->task.user_task_id, head->task.absolute_deadline, xTaskGetTickCount());
+		//Add task to overdue history
+		push_history(overdue_task_history, &head->task);
+		//Remove task from active task list
+		TaskHandle_t overdue_t_handle = heap_remove_task(active_task_list, head->task.task_id);
+		clear_promoted_task(overdue_t_handle);
+		//Stop the job, its worker goes back to the pool
+		cancel_worker_job(overdue_t_handle);
+		missed = true;
 	}
+	if(!missed){
+		return false;
+	}
+	update_priorities(active_task_list);
+
+	for(int led = 0; led < LEDn; led++){
+		STM_EVAL_LEDOff((Led_TypeDef)led);
+	}
+	return true;
 }
 
 /**
- * @brief Send a task in the completed task queue, indicating that it has completed
+ * @brief Send a task in the completed task queue, indicating that it has completed.
+ * 		  Workers also send the task id of a cancelled job, the DDS then only
+ * 		  takes the worker back.
  *
  * @param task_id (uint32_t) [in] ID of task that has completed.
  */
 void complete_dd_task( uint32_t task_id )
 {
+	uint32_t cycles_start;
+	cycle_stats_begin(cycles_start);
 	xQueueSend(xQueue_completed_dd_task, &task_id, 1000);
+	cycle_stats_end(CYCLE_OP_COMPLETION_SEND, cycles_start);
 }
 
 
 /**
- * @brief This function sends a message to a queue requesting the Active Task
- * List from the DDS. Once a response is received from the DDS, the function
- * returns the list.
+ * @brief Copy the Active Task List from the snapshot the DDS publishes. The
+ * DDS is not woken, and the copy is consistent even if the DDS updates the
+ * snapshot meanwhile. The active tasks are as of the last time the DDS woke
+ * the monitor.
+ * The get_*_dd_task_list() readers retry until the DDS is done writing, so
+ * they must not be called from an ISR or from a task above DDS_PRIORITY,
+ * such as the timer daemon: preempting the DDS mid-write, they would spin
+ * forever. The monitor is only raised above the DDS once a write is done.
  * 
- * @return (dd_task_list_t *) List of active tasks.
+ * @param active_tasks (dd_active_tasks_t *) [out] Where to copy the active tasks.
  */
-dd_task_list_t get_active_dd_task_list(void)
+void get_active_dd_task_list(dd_active_tasks_t *active_tasks)
 {
-	dd_task_list_t active_task_list;
-	init_task_list(&active_task_list);
-	xQueueSend(xQueue_request_active_task_list, &active_task_list, 1000);
-	xQueueReceive(xQueue_active_task_list, &active_task_list, 1000);
-	return active_task_list;
+	snapshot_read(&dd_snapshot, active_tasks, NULL, NULL);
 }
 
 /**
- * @brief This function sends a message to a queue requesting the Completed
- * Task List from the DDS. Once a response is received from the DDS, the
- * function returns the list.
+ * @brief Copy the Completed Task History from the snapshot the DDS publishes.
+ * Not above DDS_PRIORITY, see get_active_dd_task_list().
  * 
- * @return (dd_task_list_t **) List of completed tasks.
+ * @param completed_task_history (dd_task_history_t *) [out] Where to copy the last completed tasks.
  */
-dd_task_list_t get_completed_dd_task_list(void) {
-	dd_task_list_t completed_task_list;
-	init_task_list(&completed_task_list);
-	xQueueSend(xQueue_request_completed_task_list, &completed_task_list, 1000);
-	xQueueReceive(xQueue_completed_task_list, &completed_task_list, 1000);
-	return completed_task_list;
+void get_completed_dd_task_list(dd_task_history_t *completed_task_history) {
+	snapshot_read(&dd_snapshot, NULL, completed_task_history, NULL);
 }
 
 /**
- * @brief Get the overdue dd task list object
+ * @brief Copy the Overdue Task History from the snapshot the DDS publishes.
+ * Not above DDS_PRIORITY, see get_active_dd_task_list().
  * 
- * @return (dd_task_list_t *) List of overdue tasks.
+ * @param overdue_task_history (dd_task_history_t *) [out] Where to copy the last overdue tasks.
  */
-dd_task_list_t get_overdue_dd_task_list(void) {
-	dd_task_list_t overdue_task_list;
-	init_task_list(&overdue_task_list);
-	xQueueSend(xQueue_request_overdue_task_list, &overdue_task_list, 1000);
-	xQueueReceive(xQueue_overdue_task_list, &overdue_task_list, 1000);
-	return overdue_task_list;
+void get_overdue_dd_task_list(dd_task_history_t *overdue_task_history) {
+	snapshot_read(&dd_snapshot, NULL, NULL, overdue_task_history);
 }
 
 /**
- * @brief This function is responsible for monitoring the different task lists
+ * @brief This function is responsible for monitoring the active task list
  * 		  and reporting statistics about the tasks. It is a low priority task,
- * 		  and runs in an infinite loop.
+ * 		  and runs in an infinite loop. A report is only logged once the
+ * 		  previous one has been printed: the monitor is the only task that
+ * 		  logs, so the report then has the whole log ring to itself and is
+ * 		  printed whole. Otherwise the report is skipped and counted.
  *
  * @param pvParameters (void *) [in] Unused, should be NULL.
  * @return (static void) Does not return.
  */
 static void Monitor_Task(void *pvParameters)
 {
-
-	dd_task_list_t active_task_list;
-	init_task_list(&active_task_list);
-	dd_task_list_t completed_task_list;
-	init_task_list(&completed_task_list);
-	dd_task_list_t overdue_task_list;
-	init_task_list(&overdue_task_list);
 	for(;;){
-		// Request task information from DDS Task
-		active_task_list = get_active_dd_task_list();
-		completed_task_list = get_completed_dd_task_list();
-		overdue_task_list = get_overdue_dd_task_list();
-		taskENTER_CRITICAL();
-		// Print task information
-		printf("Monitor Task | Current Time: %u\n", (uint16_t)pdTICKS_TO_MS(xTaskGetTickCount()));
-		print_list(&active_task_list, "Active");
-		print_list(&completed_task_list, "Completed");
-		print_list(&overdue_task_list, "Overdue");
-		printf("-----------------------------\n");
+		if(dd_log_pending() == 0){
+			log_monitor_report();
+		} else {
+			monitor_reports_skipped++;
+		}
 
+		// Release the lock and suspend as one step, so the DDS cannot wake
+		// the monitor in between and have the wake up lost
+		taskENTER_CRITICAL();
 		xSemaphoreGive(monitor_task_lock);
 		// Downgrade priority of monitor task to IDLE
 		vTaskPrioritySet(xTaskGetCurrentTaskHandle(), MONITOR_IDLE_PRIORITY);
@@ -400,144 +926,412 @@ static void Monitor_Task(void *pvParameters)
 }
 
 /**
- * @brief This function is used to release a task. It sends a message to the
- * 		  task manager task to the DDS task via a queue to release the task.
- * 
- * @param t_handle (TaskHandle_t) [in] Handle to the task to be released.
+ * @brief Log one monitor report. Completed and overdue jobs are reported
+ * 		  through the per user task statistics the DDS keeps, so the report
+ * 		  costs the same however long the system has run. The report is
+ * 		  logged with dd_log(), so it is printed later by the log task and
+ * 		  never with interrupts masked. With every statistic enabled it takes
+ * 		  under a hundred records for the test benches, well within
+ * 		  DD_LOG_SIZE.
+ *
+ * @return (static void)
+ */
+static void log_monitor_report(void)
+{
+	static dd_active_tasks_t active_tasks;
+	task_stats_t task_stats;
+	dd_task_pool_stats_t pool_stats;
+	release_ring_stats_t ring_stats;
+	release_engine_stats_t engine_stats;
+	admission_stats_t admission;
+	tbs_stats_t aperiodic;
+	sched_trace_stats_t trace_stats;
+	dd_log_stats_t log_stats;
+#if ( CONSOLE_USART == 1 ) && !defined( DD_SIM_BUILD )
+	uart_console_stats_t console_stats;
+#endif
+#if ( configUSE_CYCLE_STATS == 1 )
+	static const char *const cycle_bucket_formats[CYCLE_BUCKETS_PER_RECORD + 1] = {
+		"", " %u:%u", " %u:%u %u:%u", " %u:%u %u:%u %u:%u", " %u:%u %u:%u %u:%u %u:%u"
+	};
+	cycle_stats_t cycles;
+	uint32_t bucket_args[2 * CYCLE_BUCKETS_PER_RECORD] = { 0 };
+#endif
+	// Copy task information published by the DDS Task
+	get_active_dd_task_list(&active_tasks);
+	// Log task information
+	dd_log("Monitor Task | Current Time: %u\n", (unsigned)pdTICKS_TO_MS(xTaskGetTickCount()));
+	log_active_tasks(&active_tasks, "Active");
+	dd_log("UserTID    Jobs  Missed  Dropped  Resp min    mean     max  Max late  Lateness histogram\n");
+	for(uint32_t i = 0; get_task_stats(i, &task_stats); i++){
+		if(task_stats.jobs == 0){
+			continue;
+		}
+		dd_log("%7u  %6u  %6u  %7u  %8u  %6u  %6u  %8d ", task_stats.user_task_id, task_stats.jobs, task_stats.missed,
+				task_stats.dropped, task_stats.response_min, task_stats.response_mean, task_stats.response_max, (int)task_stats.max_lateness);
+		dd_log(" %u %u %u %u %u %u %u %u\n", task_stats.lateness_histogram[0], task_stats.lateness_histogram[1],
+				task_stats.lateness_histogram[2], task_stats.lateness_histogram[3], task_stats.lateness_histogram[4],
+				task_stats.lateness_histogram[5], task_stats.lateness_histogram[6], task_stats.lateness_histogram[7]);
+	}
+	if(get_task_stats_untracked() != 0){
+		dd_log("Untracked: %u jobs of user task ids above %u\n", get_task_stats_untracked(), TASK_STATS_MAX_TASKS);
+	}
+	get_task_pool_stats(&pool_stats);
+	dd_log("Node pool: %u/%u in use, high water %u, exhausted %u\n",
+			pool_stats.in_use, pool_stats.capacity, pool_stats.high_water_mark, pool_stats.exhausted_count);
+	dd_log("Workers: %u\n", DD_WORKER_POOL_SIZE);
+	get_release_ring_stats(&release_ring, &ring_stats);
+	dd_log("Release ring: %u/%u pending, high water %u, overflow %u\n",
+			ring_stats.pending, ring_stats.capacity, ring_stats.high_water_mark, ring_stats.overflow_count);
+	get_release_ring_stats(&server_ring, &ring_stats);
+	dd_log("Server ring: %u/%u pending, high water %u, overflow %u\n",
+			ring_stats.pending, ring_stats.capacity, ring_stats.high_water_mark, ring_stats.overflow_count);
+	for(uint32_t i = 0; get_release_engine_stats(i, &engine_stats); i++){
+		dd_log("Task %u: %u releases, jitter min/mean/max %u/%u/%u us\n", engine_stats.user_task_id,
+				engine_stats.releases, engine_stats.jitter_min_us, engine_stats.jitter_mean_us, engine_stats.jitter_max_us);
+	}
+	get_admission_stats(&admission);
+	dd_log("Admission: U = %u ppm over %u tasks, %u ppm reserved, accepted %u, rejected %u, dropped after release %u\n",
+			admission.utilization_ppm, admission.periodic_tasks, admission.reserved_ppm, admission.accepted, admission.rejected,
+			admission.dropped);
+	get_tbs_stats(&aperiodic);
+	dd_log("Aperiodic: U_s = %u ppm, released %u, completed %u, overdue %u, response min/mean/max %u/%u/%u\n",
+			aperiodic.bandwidth_ppm, aperiodic.released, aperiodic.completed, aperiodic.overdue,
+			aperiodic.response_min, aperiodic.response_mean, aperiodic.response_max);
+	dd_log("Aperiodic timers: %u re-arms not queued\n", aperiodic_rearm_failed);
+	get_sched_trace_stats(&trace_stats);
+	dd_log("Trace: %u events, %u overwritten\n", trace_stats.written, trace_stats.overwritten);
+#ifdef DD_SIM_BUILD
+	// Blocks are not timed in the simulation, each is one quantum
+	dd_log("Workload cycles per block: %s %u, %s %u, %s %u (one simulated quantum, measured on target only)\n",
+#else
+	dd_log("Workload cycles per block: %s %u, %s %u, %s %u\n",
+#endif
+			get_workload_name(WORKLOAD_INTEGER), get_workload_block_cycles(WORKLOAD_INTEGER),
+			get_workload_name(WORKLOAD_FPU), get_workload_block_cycles(WORKLOAD_FPU),
+			get_workload_name(WORKLOAD_MEMORY), get_workload_block_cycles(WORKLOAD_MEMORY));
+	get_dd_log_stats(&log_stats);
+	dd_log("Log: %u records, %u dropped, high water %u/%u, %u reports skipped\n",
+			log_stats.logged, log_stats.dropped, log_stats.high_water_mark, DD_LOG_SIZE, monitor_reports_skipped);
+#ifndef DD_SIM_BUILD
+	// The simulated tasks run on the stacks of their threads instead
+	UBaseType_t worker_stack_free = WORKER_STACK_SIZE;
+	for(int i = 0; i < DD_WORKER_POOL_SIZE; i++){
+		UBaseType_t stack_free = uxTaskGetStackHighWaterMark(worker_pool[i].t_handle);
+		if(stack_free < worker_stack_free){
+			worker_stack_free = stack_free;
+		}
+	}
+	// The monitor is the calling task, NULL
+	dd_log("Stack high water: DDS %u/%u, monitor %u/%u, log %u/%u, workers %u/%u words free\n",
+			(unsigned)uxTaskGetStackHighWaterMark(dds_t_handle), DDS_STACK_SIZE,
+			(unsigned)uxTaskGetStackHighWaterMark(NULL), MONITOR_STACK_SIZE,
+			(unsigned)uxTaskGetStackHighWaterMark(log_t_handle), LOG_STACK_SIZE,
+			(unsigned)worker_stack_free, WORKER_STACK_SIZE);
+#endif
+#if ( CONSOLE_USART == 1 ) && !defined( DD_SIM_BUILD )
+	get_uart_console_stats(&console_stats);
+	dd_log("Console: %u bytes in %u transfers, %u dropped\n",
+			console_stats.sent, console_stats.transfers, console_stats.dropped);
+#endif
+#if ( configUSE_CYCLE_STATS == 1 )
+	for(cycle_stats_op_t op = 0; get_cycle_stats(op, &cycles); op++){
+		if(cycles.count == 0){
+			continue;
+		}
+		dd_log("%s: %u, cycles min/mean/max %u/%u/%u, log2 histogram", get_cycle_stats_name(op),
+				cycles.count, cycles.min, cycles.mean, cycles.max);
+		// Up to CYCLE_BUCKETS_PER_RECORD buckets per record, so the report
+		// stays well within the log ring
+		uint32_t buckets = 0;
+		for(uint32_t bucket = 0; bucket < CYCLE_STATS_BUCKETS; bucket++){
+			if(cycles.histogram[bucket] != 0){
+				bucket_args[2 * buckets] = bucket;
+				bucket_args[2 * buckets + 1] = cycles.histogram[bucket];
+				buckets++;
+			}
+			if(buckets == CYCLE_BUCKETS_PER_RECORD || (bucket == CYCLE_STATS_BUCKETS - 1 && buckets > 0)){
+				dd_log(cycle_bucket_formats[buckets], bucket_args[0], bucket_args[1], bucket_args[2], bucket_args[3],
+						bucket_args[4], bucket_args[5], bucket_args[6], bucket_args[7]);
+				buckets = 0;
+			}
+		}
+		dd_log("\n");
+	}
+#endif
+	dd_log("-----------------------------\n");
+}
+
+/**
+ * @brief This task prints the records logged with dd_log(). It runs above
+ * 		  the workers, so the log drains under any load, a batch of at most
+ * 		  LOG_DRAIN_BATCH records every LOG_DRAIN_PERIOD_MS. Records dropped
+ * 		  because the ring was full are reported straight to the console
+ * 		  once the ring is empty, since a record counting them could be
+ * 		  dropped as well.
+ *
+ * @param pvParameters (void *) [in] Unused, should be NULL.
+ * @return (static void) Does not return.
+ */
+static void Log_Task(void *pvParameters)
+{
+	dd_log_stats_t log_stats;
+	uint32_t reported_dropped = 0;
+
+	for(;;){
+		dd_log_drain(LOG_DRAIN_BATCH);
+		get_dd_log_stats(&log_stats);
+		// Not in the middle of a line, so only once the ring is empty
+		if(log_stats.dropped != reported_dropped && dd_log_pending() == 0){
+			reported_dropped = log_stats.dropped;
+			printf("Log: %u records dropped\n", (unsigned)reported_dropped);
+		}
+		vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+	}
+}
+
+/**
+ * @brief Run the admission test for a job and, if it is accepted, push it on
+ * 		  the release ring. Called by release_dd_task() with the release engine
+ * 		  interrupt masked, or from the interrupt itself.
+ *
  * @param type (task_type_t) [in] Type of task to be released (PERIODIC or APERIODIC).
- * @param execution_time (uint32_t) [in] Execution time of task to be released.
- * @param absolute_deadline (uint32_t) [in] Absolute deadline of task to be released.
+ * @param user_task_id (uint32_t) [in] User task the job belongs to.
+ * @param absolute_deadline (uint32_t) [in] Absolute deadline, 0 for a server job.
+ * @param execution_time (uint32_t) [in] Worst case execution time of the job in ticks.
+ * @param now (uint32_t) [in] Current tick count.
+ * @param pushed (bool *) [out] Whether the job was pushed on the ring.
+ * @return (static admission_result_t) As release_dd_task().
  */
-void release_dd_task(
-	task_type_t type,
-	uint32_t user_task_id,
-	uint32_t absolute_deadline
-){
+static admission_result_t admit_and_push(task_type_t type, uint32_t user_task_id, uint32_t absolute_deadline,
+		uint32_t execution_time, uint32_t now, bool *pushed)
+{
+	admission_result_t result;
+
+	// Server jobs wait for the server on their own ring. Room is checked
+	// first, so the admission and server state only count jobs that are
+	// queued, and the server deadline never moves for a dropped job.
+	bool server_job = type == APERIODIC && absolute_deadline == 0;
+	release_ring_t *ring = server_job ? &server_ring : &release_ring;
+	*pushed = false;
+	if(!release_ring_reserve(ring)){
+		return ADMISSION_REJECTED_FULL;
+	}
+	if(type == PERIODIC){
+		result = admit_periodic_job(user_task_id);
+	} else if(server_job){
+		// The server bandwidth was reserved at start, its jobs need no test
+		if(!tbs_assign_deadline(now, execution_time, &absolute_deadline)){
+			return ADMISSION_REJECTED_UNKNOWN;
+		}
+		result = ADMISSION_ACCEPTED;
+	} else {
+		result = admit_aperiodic_job(now, absolute_deadline, execution_time);
+	}
+	if(result != ADMISSION_ACCEPTED && ADMISSION_ENFORCE){
+		return result;
+	}
+
 	dd_task_t new_task;
 	new_task.type = type;
+	new_task.release_time = now;
 	new_task.completion_time = 0;
 	new_task.user_task_id = user_task_id;
 	new_task.absolute_deadline = absolute_deadline;
-	xQueueSend(xQueue_new_dd_task,&new_task,1000);
+	release_ring_push(ring, &new_task);
+	*pushed = true;
+	return result;
 }
 
 /**
- * @brief This function is used to create periodic tasks and is triggered by a
- * 		  timer. Three different periodic tasks can trigger this function, and 
- *        the timer handle can be used to determine which task is to be released.
+ * @brief This function is used to release a task. It runs the admission test
+ * 		  for the job and, if it is accepted, pushes it on the release ring
+ * 		  and wakes the DDS task. It never blocks, so it can be called from
+ * 		  a timer callback or an ISR. Periodic jobs come from the release engine
+ * 		  interrupt, aperiodic jobs from the timer daemon.
  * 
- * @param xTimer (xTimerHandle) [in] Handle to the timer that created the task.
- * @return (void)
+ * @param type (task_type_t) [in] Type of task to be released (PERIODIC or APERIODIC).
+ * @param user_task_id (uint32_t) [in] User task the job belongs to.
+ * @param absolute_deadline (uint32_t) [in] Absolute deadline of task to be released.
+ * 		  0 for an aperiodic job lets the Total Bandwidth Server assign it.
+ * @param execution_time (uint32_t) [in] Worst case execution time of the job in ticks,
+ * 		  only used for aperiodic jobs.
+ * @return (admission_result_t) ADMISSION_ACCEPTED if the job was released. With
+ * 		  ADMISSION_ENFORCE set to 0 the job is released whatever the result,
+ * 		  except for a server job while the server is off. ADMISSION_REJECTED_FULL
+ * 		  if the release ring overflowed.
  */
-void Task_Generator_Task( TimerHandle_t xTimer )
-{
-	task_type_t t;
-
-	if(xTimer == xTimer_task1){
-		t = PERIODIC;
-		release_dd_task(t, 1, xTaskGetTickCount()+pdMS_TO_TICKS(TASK1_PERIOD));
-		xTimerChangePeriod(xTimer, pdMS_TO_TICKS(TASK1_PERIOD), 1000);
-	} else if(xTimer == xTimer_task2){
-		t = PERIODIC;
-		release_dd_task(t, 2, xTaskGetTickCount()+pdMS_TO_TICKS(TASK2_PERIOD));
-		xTimerChangePeriod(xTimer, pdMS_TO_TICKS(TASK2_PERIOD), 1000);
-	} else if(xTimer == xTimer_task3){
-		t = PERIODIC;
-		release_dd_task(t, 3, xTaskGetTickCount()+pdMS_TO_TICKS(TASK3_PERIOD));
-		xTimerChangePeriod(xTimer, pdMS_TO_TICKS(TASK3_PERIOD), 1000);
-	} else{
-		// Aperiodic Implementation
+admission_result_t release_dd_task(
+	task_type_t type,
+	uint32_t user_task_id,
+	uint32_t absolute_deadline,
+	uint32_t execution_time
+){
+	bool from_isr = xPortIsInsideInterrupt();
+	bool pushed;
+	admission_result_t result;
+
+	if(from_isr){
+		result = admit_and_push(type, user_task_id, absolute_deadline, execution_time, xTaskGetTickCountFromISR(), &pushed);
+	} else {
+		// Mask the release engine interrupt, the other producer, while the
+		// admission control and the release ring are updated
+		taskENTER_CRITICAL();
+		result = admit_and_push(type, user_task_id, absolute_deadline, execution_time, xTaskGetTickCount(), &pushed);
+		taskEXIT_CRITICAL();
 	}
-
+	if(pushed){
+		signal_release(from_isr);
+	}
+	return result;
 }
 
-
 /**
- * @brief Application code for tracking the execution of user defined tasks. Turns
- * 		  on the LED amber LED when the task is executing, and turns it off when it
- * 		  completes.
+ * @brief Wake the DDS after a release. Only the first release since the DDS
+ * 		  last drained the ring gives the semaphore, so a burst costs a
+ * 		  single kernel call.
  *
- * @param (void *) pvParameters [in] Task to be executed. Cast to (dd_task_t *)
+ * @param from_isr (bool) [in] Whether the release came from an interrupt.
+ * @return (static void)
  */
-static void User_Defined_Task1( void * pvParameters)
+static void signal_release( bool from_isr )
 {
-	uint32_t prev_ticks, curr_ticks;
-
-	//Copy values of pvParameters to local variable
-	dd_task_t * task = (dd_task_t *)pvParameters;
-	STM_EVAL_LEDOn(amber_led);
-
-	uint32_t ticks = pdMS_TO_TICKS(TASK1_EXEC_TIME);
-
-	while(ticks--){
-		prev_ticks = xTaskGetTickCount();
-		do {
-			curr_ticks = xTaskGetTickCount();
-		} while(prev_ticks == curr_ticks);
-
+	if(release_signalled){
+		return;
+	}
+	release_signalled = true;
+	if(from_isr){
+		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+		xSemaphoreGiveFromISR(release_pending, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+	} else {
+		xSemaphoreGive(release_pending);
 	}
-	STM_EVAL_LEDOff(amber_led);
+}
 
-	complete_dd_task(task->task_id);
-	vTaskDelete(xTaskGetCurrentTaskHandle());
+/**
+ * @brief Callback of the one-shot deadline timer. Wakes the DDS so that it
+ * 		  moves the expired tasks to the overdue list.
+ *
+ * @param xTimer (xTimerHandle) [in] Unused, always the deadline timer.
+ * @return (void)
+ */
+static void Deadline_Timer_Callback( TimerHandle_t xTimer )
+{
+	( void ) xTimer;
+	xSemaphoreGive(deadline_expired);
 }
 
 /**
- * @brief Application code for tracking the execution of user defined tasks. Turns
- * 		  on the LED green LED when the task is executing, and turns it off when it
- * 		  completes.
+ * @brief Called by the release engine interrupt at the nominal release time
+ * 		  of a periodic job, with the deadline computed from that time.
  *
- * @param (void *) pvParameters [in] Task to be executed. Cast to (dd_task_t *)
+ * @param user_task_id (uint32_t) [in] User task the job belongs to.
+ * @param absolute_deadline (uint32_t) [in] Nominal release time plus relative deadline, in ticks.
+ * @param execution_time (uint32_t) [in] Worst case execution time of the job in ticks.
  * @return (static void)
  */
-static void User_Defined_Task2( void * pvParameters)
+static void release_periodic_job( uint32_t user_task_id, uint32_t absolute_deadline, uint32_t execution_time )
 {
-	uint32_t prev_ticks, curr_ticks;
-	dd_task_t * task = (dd_task_t *)pvParameters;
-	STM_EVAL_LEDOn(green_led);
-
-	uint32_t ticks = pdMS_TO_TICKS(TASK2_EXEC_TIME);
+	release_dd_task(PERIODIC, user_task_id, absolute_deadline, execution_time);
+}
 
-	while(ticks--){
-		prev_ticks = xTaskGetTickCount();
-		do {
-			curr_ticks = xTaskGetTickCount();
-		} while(prev_ticks == curr_ticks);
+/**
+ * @brief Next number of a xorshift32 sequence. rand() is not reentrant, and
+ * 		  this state is only used from the timer daemon.
+ *
+ * @return (static uint32_t) The number.
+ */
+static uint32_t arrival_random( void )
+{
+	uint32_t x = arrival_random_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	arrival_random_state = x;
+	return x;
+}
 
+/**
+ * @brief This function is used to create aperiodic tasks and is triggered by
+ * 		  the timer of an aperiodic task of the task set, whose id is the
+ * 		  table index. It releases a burst of aperiodic jobs and re-arms the
+ * 		  timer after a random interval. It runs in the timer daemon, so it
+ * 		  never blocks: if the timer queue is full the timer keeps its
+ * 		  previous interval. Jobs without a relative deadline are
+ * 		  served by the Total Bandwidth Server. Periodic tasks are released by
+ * 		  the release engine.
+ * 
+ * @param xTimer (xTimerHandle) [in] Handle to the timer that created the task.
+ * @return (void)
+ */
+void Task_Generator_Task( TimerHandle_t xTimer )
+{
+	uint32_t index = (uint32_t)(uintptr_t)pvTimerGetTimerID(xTimer);
+	const dd_task_desc_t *desc = &TASK_SET[index];
+	uint32_t burst = 1 + arrival_random() % APERIODIC_MAX_BURST;
+
+	while(burst--){
+		uint32_t absolute_deadline = 0;
+		if(desc->relative_deadline != 0){
+			absolute_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(desc->relative_deadline);
+		}
+		release_dd_task(APERIODIC, index + 1, absolute_deadline, pdMS_TO_TICKS(desc->execution_time));
+	}
+	if(xTimerChangePeriod(xTimer, pdMS_TO_TICKS(1 + arrival_random() % (2 * desc->period)), 0) != pdPASS){
+		aperiodic_rearm_failed++;
 	}
-	STM_EVAL_LEDOff(green_led);
-
-	complete_dd_task(task->task_id);
-	vTaskDelete(xTaskGetCurrentTaskHandle());
 }
 
+
 /**
- * @brief Application code for tracking the execution of user defined tasks. Turns
- * 		  on the LED red LED when the task is executing, and turns it off when it
- * 		  completes.
+ * @brief Worker of the pool. Blocks until the DDS hands it a job, runs the job
+ * 		  function of the job's user task, reports that the job returned and
+ * 		  goes back to waiting. Workers are created once, so releasing a job never
+ * 		  allocates a task.
  *
- * @param (void *) pvParameters [in] Task to be executed. Cast to (dd_task_t *)
- * @return (static void)
+ * @param (void *) pvParameters [in] The worker. Cast to (dd_worker_t *)
+ * @return (static void) Does not return.
  */
-static void User_Defined_Task3( void * pvParameters)
+static void Worker_Task( void * pvParameters)
 {
-	uint32_t prev_ticks, curr_ticks;
-	dd_task_t * task = (dd_task_t *)pvParameters;
-	STM_EVAL_LEDOn(red_led);
-
-	uint32_t ticks = pdMS_TO_TICKS(TASK3_EXEC_TIME);
+	dd_worker_t * worker = (dd_worker_t *)pvParameters;
 
-	while(ticks--){
-		prev_ticks = xTaskGetTickCount();
-		do {
-			curr_ticks = xTaskGetTickCount();
-		} while(prev_ticks == curr_ticks);
+	for(;;){
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		sched_trace(SCHED_TRACE_START, worker->job.task_id, worker->job.user_task_id);
 
+		// Every job goes through the task set table
+		uint32_t index = worker->job.user_task_id - 1;
+		if(index < TASK_SET_SIZE){
+			TASK_SET[index].job(worker, &TASK_SET[index]);
+		}
+		if(!worker->cancelled){
+			sched_trace(SCHED_TRACE_COMPLETE, worker->job.task_id, worker->job.user_task_id);
+		}
+		// Report, cancelled or not, while still running at the priority of
+		// the job. The DDS returns the worker to the pool, at idle priority
+		// or without a deadline, and may hand it the next job at once, so
+		// the job must not be touched after this.
+		complete_dd_task(worker->job.task_id);
 	}
-	STM_EVAL_LEDOff(red_led);
+}
 
-	complete_dd_task(task->task_id);
-	vTaskDelete(xTaskGetCurrentTaskHandle());
+/**
+ * @brief Application code for tracking the execution of user defined tasks. Turns
+ * 		  on the LED of the task when the job is executing, and turns it off when
+ * 		  it completes. The job executes the workload of its task for its execution
+ * 		  time, counted in its own cycles, so time spent preempted does not count.
+ *
+ * @param (dd_worker_t *) worker [in] Worker running the job.
+ * @param (const dd_task_desc_t *) desc [in] Task set entry of the job.
+ * @return (static void)
+ */
+static void User_Defined_Task( dd_worker_t *worker, const dd_task_desc_t *desc )
+{
+	STM_EVAL_LEDOn(desc->led);
+	workload_run(desc->workload, desc->execution_time, &worker->cancelled);
+	STM_EVAL_LEDOff(desc->led);
 }
 
 /*-----------------------------------------------------------*/
@@ -555,6 +1349,17 @@ void vApplicationMallocFailedHook( void )
 }
 /*-----------------------------------------------------------*/
 
+void vApplicationTaskPoolExhaustedHook( void )
+{
+	/* Called by linked_list.c when a dd_task_node_t cannot be allocated
+	because all DD_TASK_POOL_SIZE nodes are in use. The allocation fails and
+	the caller drops the task, so the red LED is used to flag the condition.
+	The number of failures is kept in the pool exhausted_count, which the
+	monitor task reports. */
+	STM_EVAL_LEDOn(red_led);
+}
+/*-----------------------------------------------------------*/
+
 void vApplicationStackOverflowHook( xTaskHandle pxTask, signed char *pcTaskName )
 {
 	( void ) pcTaskName;
@@ -587,6 +1392,12 @@ volatile size_t xFreeStackSpace;
 		the value of configTOTAL_HEAP_SIZE in FreeRTOSConfig.h can be
 		reduced accordingly. */
 	}
+
+#ifdef DD_SIM_BUILD
+	/* Nothing to run: let simulated time move on to the next tick, as the
+	core would sleep until the next interrupt. */
+	vPortSimIdle();
+#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -598,4 +1409,9 @@ static void prvSetupHardware( void )
 
 	/* TODO: Setup the clocks, etc. here, if they were not configured before
 	main() was called. */
+
+#if ( CONSOLE_USART == 1 ) && !defined( DD_SIM_BUILD )
+	/* printf goes out on USART2 as well as, or instead of, the ITM. */
+	init_uart_console();
+#endif
 }
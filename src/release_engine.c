@@ -0,0 +1,261 @@
+/**
+ * @file release_engine.c
+ * @brief Periodic release engine on the 32-bit TIM2, counting microseconds.
+ *    Each task keeps its nominal release time, phase + k * period, as an
+ *    offset in milliseconds from the engine start. The capture/compare 1
+ *    interrupt is set to the earliest nominal release. Release times and
+ *    deadlines never depend on when an interrupt or callback actually ran,
+ *    so latency shows up as jitter but never adds up to drift. TIM2 and the
+ *    tick both run from HCLK, so nominal times map onto ticks exactly. The
+ *    deadlines handed out are kept in ticks next to the millisecond times,
+ *    converted once per task, so they wrap with the tick count and not with
+ *    a conversion of the whole uptime.
+ *
+ *    Tasks are added before release_engine_start(), from a single task.
+ *
+ *    The simulated host build has no TIM2. The handler is called from the
+ *    tick hook instead and the counter is the tick count in microseconds, so
+ *    releases have tick resolution and no jitter.
+ */
+
+#include "stm32f4xx.h"
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "release_engine.h"
+
+#define US_PER_MS 1000
+
+#ifdef DD_SIM_BUILD
+#define engine_counter() ((uint32_t)(xTaskGetTickCountFromISR() * (US_PER_MS * 1000 / configTICK_RATE_HZ)))
+#else
+#define engine_counter() TIM_GetCounter(TIM2)
+#endif
+
+/**
+ * @brief Periodic task released by the engine
+ *
+ * @param period (uint32_t) Period in ms
+ * @param execution_time (uint32_t) Worst case execution time in ms
+ * @param relative_deadline (uint32_t) Relative deadline in ms
+ * @param next_release (uint32_t) Nominal time of the next release, in ms from the start
+ * @param period_ticks (TickType_t) Period in ticks
+ * @param relative_deadline_ticks (TickType_t) Relative deadline in ticks
+ * @param next_release_tick (TickType_t) Nominal time of the next release, in ticks from the start
+ * @param jitter_total_us (uint64_t) Sum of the release jitter, for the mean
+ * @param stats (release_engine_stats_t) Release counters
+ */
+typedef struct release_engine_task {
+    uint32_t period;
+    uint32_t execution_time;
+    uint32_t relative_deadline;
+    uint32_t next_release;
+    TickType_t period_ticks;
+    TickType_t relative_deadline_ticks;
+    TickType_t next_release_tick;
+    uint64_t jitter_total_us;
+    release_engine_stats_t stats;
+} release_engine_task_t;
+
+static release_engine_task_t engine_tasks[RELEASE_ENGINE_MAX_TASKS];
+static uint32_t engine_task_count = 0;
+static release_engine_callback_t release_callback = NULL;
+static uint32_t start_count = 0;
+static TickType_t start_tick = 0;
+
+/**
+ * @brief Register a periodic task, released first at its phase
+ *
+ * @param user_task_id (uint32_t) [IN] The user task id
+ * @param period (uint32_t) [IN] Period in ms, must not be 0
+ * @param execution_time (uint32_t) [IN] Worst case execution time in ms
+ * @param relative_deadline (uint32_t) [IN] Relative deadline in ms, 0 for the period
+ * @param phase (uint32_t) [IN] Time of the first release in ms from the start
+ * @return (bool) false if the table is full or the period is 0
+ */
+bool release_engine_add_task(uint32_t user_task_id, uint32_t period,
+    uint32_t execution_time, uint32_t relative_deadline, uint32_t phase) {
+    if (period == 0 || engine_task_count >= RELEASE_ENGINE_MAX_TASKS) {
+        return false;
+    }
+    release_engine_task_t *task = &engine_tasks[engine_task_count++];
+    task->period = period;
+    task->execution_time = execution_time;
+    task->relative_deadline = relative_deadline == 0 ? period : relative_deadline;
+    task->next_release = phase;
+    task->period_ticks = pdMS_TO_TICKS(period);
+    task->relative_deadline_ticks = pdMS_TO_TICKS(task->relative_deadline);
+    task->next_release_tick = pdMS_TO_TICKS(phase);
+    task->jitter_total_us = 0;
+    task->stats.user_task_id = user_task_id;
+    task->stats.releases = 0;
+    task->stats.jitter_min_us = 0;
+    task->stats.jitter_max_us = 0;
+    task->stats.jitter_mean_us = 0;
+    return true;
+}
+
+/**
+ * @brief Counter value of the nominal release time of a task
+ *
+ * @param task (release_engine_task_t *) [IN] The task
+ * @return (uint32_t) TIM2 count, wraps around every 71 minutes
+ */
+static uint32_t release_count(const release_engine_task_t *task) {
+    return start_count + task->next_release * US_PER_MS;
+}
+
+/**
+ * @brief Start TIM2 at 1 MHz and the releases. Time 0 of every phase is now.
+ *        Must be called from a task once the consumer of the releases runs.
+ *
+ * @param callback (release_engine_callback_t) [IN] Called for each released job
+ * @return (void)
+ */
+void release_engine_start(release_engine_callback_t callback) {
+    release_callback = callback;
+
+#ifdef DD_SIM_BUILD
+    taskENTER_CRITICAL();
+    start_tick = xTaskGetTickCount();
+    start_count = engine_counter();
+    taskEXIT_CRITICAL();
+    // Release the tasks with phase 0 right away
+    release_engine_irq_handler();
+#else
+    RCC_ClocksTypeDef clocks;
+    TIM_TimeBaseInitTypeDef time_base;
+
+    // APB1 timers run at twice PCLK1 when APB1 is divided
+    RCC_GetClocksFreq(&clocks);
+    uint32_t timer_clock = clocks.PCLK1_Frequency;
+    if (clocks.PCLK1_Frequency != clocks.HCLK_Frequency) {
+        timer_clock *= 2;
+    }
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+    TIM_TimeBaseStructInit(&time_base);
+    time_base.TIM_Prescaler = (uint16_t)(timer_clock / (US_PER_MS * 1000) - 1);
+    time_base.TIM_Period = 0xFFFFFFFF;
+    time_base.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(TIM2, &time_base);
+
+    // The interrupt releases jobs through the kernel, so it must not be
+    // above the maximum syscall priority
+    NVIC_SetPriority(TIM2_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+    NVIC_EnableIRQ(TIM2_IRQn);
+
+    taskENTER_CRITICAL();
+    start_tick = xTaskGetTickCount();
+    TIM_Cmd(TIM2, ENABLE);
+    start_count = TIM_GetCounter(TIM2);
+    // Release the tasks with phase 0 right away
+    TIM_SetCompare1(TIM2, start_count + 1);
+    TIM_ClearITPendingBit(TIM2, TIM_IT_CC1);
+    TIM_ITConfig(TIM2, TIM_IT_CC1, ENABLE);
+    taskEXIT_CRITICAL();
+#endif
+}
+
+/**
+ * @brief Release every job whose nominal release time has come, then set
+ *        the compare register to the next nominal release. Called from
+ *        TIM2_IRQHandler(), or from the tick hook in the simulated build.
+ *
+ * @return (void)
+ */
+void release_engine_irq_handler(void) {
+#ifdef DD_SIM_BUILD
+    if (release_callback == NULL) {
+        return;
+    }
+#else
+    if (TIM_GetITStatus(TIM2, TIM_IT_CC1) == RESET) {
+        return;
+    }
+    TIM_ClearITPendingBit(TIM2, TIM_IT_CC1);
+#endif
+
+    for (;;) {
+        uint32_t now = engine_counter();
+        uint32_t next = 0;
+        bool pending = false;
+
+        for (uint32_t i = 0; i < engine_task_count; i++) {
+            release_engine_task_t *task = &engine_tasks[i];
+            // Catch up if releases were held back, one job per nominal time
+            while ((int32_t)(now - release_count(task)) >= 0) {
+                uint32_t jitter = now - release_count(task);
+                if (task->stats.releases == 0 || jitter < task->stats.jitter_min_us) {
+                    task->stats.jitter_min_us = jitter;
+                }
+                if (jitter > task->stats.jitter_max_us) {
+                    task->stats.jitter_max_us = jitter;
+                }
+                task->stats.releases++;
+                task->jitter_total_us += jitter;
+                task->stats.jitter_mean_us = (uint32_t)(task->jitter_total_us / task->stats.releases);
+
+                release_callback(task->stats.user_task_id,
+                    start_tick + task->next_release_tick + task->relative_deadline_ticks,
+                    pdMS_TO_TICKS(task->execution_time));
+                task->next_release += task->period;
+                task->next_release_tick += task->period_ticks;
+            }
+            if (!pending || (int32_t)(release_count(task) - next) < 0) {
+                next = release_count(task);
+                pending = true;
+            }
+        }
+        if (!pending) {
+            return;
+        }
+#ifndef DD_SIM_BUILD
+        TIM_SetCompare1(TIM2, next);
+#endif
+        // The compare only fires on equality, check the next release has
+        // not already gone by while this one was handled
+        if ((int32_t)(engine_counter() - next) < 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Time since the engine started, the time base of the release jitter
+ *        and of the scheduler trace
+ *
+ * @return (uint32_t) Time in microseconds, 0 before the start. Wraps around
+ *         every 71 minutes.
+ */
+uint32_t get_release_engine_time_us(void) {
+    if (release_callback == NULL) {
+        return 0;
+    }
+    return engine_counter() - start_count;
+}
+
+/**
+ * @brief Number of tasks registered with the engine
+ *
+ * @return (uint32_t) Number of tasks
+ */
+uint32_t get_release_engine_task_count(void) {
+    return engine_task_count;
+}
+
+/**
+ * @brief Copy the release counters of a task. The counters are updated by
+ *        the interrupt, so they may be one release apart from each other.
+ *
+ * @param index (uint32_t) [IN] Index of the task, in registration order
+ * @param stats (release_engine_stats_t *) [OUT] Where to copy the counters
+ * @return (bool) false if there is no task at index
+ */
+bool get_release_engine_stats(uint32_t index, release_engine_stats_t *stats) {
+    if (index >= engine_task_count) {
+        return false;
+    }
+    *stats = engine_tasks[index].stats;
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef RELEASE_ENGINE_H
+#define RELEASE_ENGINE_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Maximum number of periodic tasks the engine releases
+ */
+#ifndef RELEASE_ENGINE_MAX_TASKS
+#define RELEASE_ENGINE_MAX_TASKS 64
+#endif
+
+/**
+ * @brief Called from the TIM2 interrupt for every periodic job released
+ *
+ * @param user_task_id (uint32_t) The user task id of the job
+ * @param absolute_deadline (uint32_t) Deadline in ticks, from the nominal release time
+ * @param execution_time (uint32_t) Worst case execution time in ticks
+ */
+typedef void (*release_engine_callback_t)(uint32_t user_task_id,
+    uint32_t absolute_deadline, uint32_t execution_time);
+
+/**
+ * @brief Release counters of a periodic task. Jitter is the time between the
+ *        nominal release time and the moment the interrupt released the job.
+ *
+ * @param user_task_id (uint32_t) The user task id
+ * @param releases (uint32_t) Number of jobs released
+ * @param jitter_min_us (uint32_t) Smallest release jitter in microseconds
+ * @param jitter_max_us (uint32_t) Largest release jitter in microseconds
+ * @param jitter_mean_us (uint32_t) Mean release jitter in microseconds
+ */
+typedef struct release_engine_stats {
+    uint32_t user_task_id;
+    uint32_t releases;
+    uint32_t jitter_min_us;
+    uint32_t jitter_max_us;
+    uint32_t jitter_mean_us;
+} release_engine_stats_t;
+
+
+bool release_engine_add_task(uint32_t user_task_id, uint32_t period,
+    uint32_t execution_time, uint32_t relative_deadline, uint32_t phase);
+void release_engine_start(release_engine_callback_t callback);
+void release_engine_irq_handler(void);
+uint32_t get_release_engine_time_us(void);
+uint32_t get_release_engine_task_count(void);
+bool get_release_engine_stats(uint32_t index, release_engine_stats_t *stats);
+
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file release_ring.c
+ * @brief Wait-free single producer, single consumer ring used to hand
+ *    released DD-tasks from the task generator (a timer callback or an ISR)
+ *    to the DDS without kernel calls. Head and tail are free running
+ *    counters, the slot of a count is count & (RELEASE_RING_SIZE - 1), and
+ *    the ring is full when head - tail equals the size. A memory barrier
+ *    orders the slot write before the head update, and the slot read before
+ *    the tail update.
+ */
+
+#include "release_ring.h"
+
+#define RELEASE_RING_MASK (RELEASE_RING_SIZE - 1)
+
+/* Keep slot accesses on the right side of the index update, also emits a
+dmb on the Cortex-M4. */
+#define release_ring_barrier() __sync_synchronize()
+
+/**
+ * @brief Initialize an empty release ring
+ *
+ * @param ring (release_ring_t *) [IN] The ring
+ * @return (void)
+ */
+void init_release_ring(release_ring_t *ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->high_water_mark = 0;
+    ring->overflow_count = 0;
+}
+
+/**
+ * @brief Push a released task. Producer side only, safe from an ISR.
+ *
+ * @param ring (release_ring_t *) [IN] The ring
+ * @param task (dd_task_t *) [IN] The task to copy in
+ * @return (bool) false if the ring was full and the release was dropped
+ */
+bool release_ring_push(release_ring_t *ring, const dd_task_t *task) {
+    uint32_t head = ring->head;
+    uint32_t pending = head - ring->tail;
+    if (pending >= RELEASE_RING_SIZE) {
+        ring->overflow_count++;
+        return false;
+    }
+    ring->slots[head & RELEASE_RING_MASK] = *task;
+    release_ring_barrier();
+    ring->head = head + 1;
+    if (pending + 1 > ring->high_water_mark) {
+        ring->high_water_mark = pending + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Check that the next push will not overflow, before the producer
+ *        commits state that only holds for a queued task. Producer side
+ *        only, the consumer can only make room meanwhile. A full ring counts
+ *        as an overflow, like the push that would have followed.
+ *
+ * @param ring (release_ring_t *) [IN] The ring
+ * @return (bool) false if the ring is full
+ */
+bool release_ring_reserve(release_ring_t *ring) {
+    if (ring->head - ring->tail >= RELEASE_RING_SIZE) {
+        ring->overflow_count++;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Pop the oldest released task. Consumer side only.
+ *
+ * @param ring (release_ring_t *) [IN] The ring
+ * @param task (dd_task_t *) [OUT] Where to copy the task
+ * @return (bool) false if the ring was empty
+ */
+bool release_ring_pop(release_ring_t *ring, dd_task_t *task) {
+    uint32_t tail = ring->tail;
+    if (tail == ring->head) {
+        return false;
+    }
+    release_ring_barrier();
+    *task = ring->slots[tail & RELEASE_RING_MASK];
+    release_ring_barrier();
+    ring->tail = tail + 1;
+    return true;
+}
+
+/**
+ * @brief Copy the ring counters. The counters are read without locking, so
+ *        they may be one release apart from each other.
+ *
+ * @param ring (release_ring_t *) [IN] The ring
+ * @param stats (release_ring_stats_t *) [OUT] Where to copy the counters
+ * @return (void)
+ */
+void get_release_ring_stats(const release_ring_t *ring, release_ring_stats_t *stats) {
+    stats->capacity = RELEASE_RING_SIZE;
+    stats->pending = ring->head - ring->tail;
+    stats->high_water_mark = ring->high_water_mark;
+    stats->overflow_count = ring->overflow_count;
+}
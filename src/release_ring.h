@@ -0,0 +1,64 @@
+#ifndef RELEASE_RING_H
+#define RELEASE_RING_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "./linked_list.h"
+
+/**
+ * @brief Number of releases the ring holds, must be a power of two
+ */
+#ifndef RELEASE_RING_SIZE
+#define RELEASE_RING_SIZE 32
+#endif
+
+#if (RELEASE_RING_SIZE & (RELEASE_RING_SIZE - 1)) != 0
+#error "RELEASE_RING_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Single producer, single consumer ring of released DD-tasks. The
+ *        producer (timer callback or ISR) only writes head and its counters,
+ *        the consumer (the DDS) only writes tail, so neither side ever waits
+ *        for the other.
+ *
+ * @param slots (dd_task_t[]) Released tasks
+ * @param head (uint32_t) Free running count of pushed tasks
+ * @param tail (uint32_t) Free running count of popped tasks
+ * @param high_water_mark (uint32_t) Most tasks ever waiting in the ring
+ * @param overflow_count (uint32_t) Number of releases dropped because the ring was full
+ */
+typedef struct release_ring {
+    dd_task_t slots[RELEASE_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t high_water_mark;
+    volatile uint32_t overflow_count;
+} release_ring_t;
+
+/**
+ * @brief Release ring counters
+ *
+ * @param capacity (uint32_t) Number of slots
+ * @param pending (uint32_t) Tasks pushed and not popped yet
+ * @param high_water_mark (uint32_t) Most tasks ever waiting in the ring
+ * @param overflow_count (uint32_t) Number of releases dropped because the ring was full
+ */
+typedef struct release_ring_stats {
+    uint32_t capacity;
+    uint32_t pending;
+    uint32_t high_water_mark;
+    uint32_t overflow_count;
+} release_ring_stats_t;
+
+
+void init_release_ring(release_ring_t *ring);
+bool release_ring_reserve(release_ring_t *ring);
+bool release_ring_push(release_ring_t *ring, const dd_task_t *task);
+bool release_ring_pop(release_ring_t *ring, dd_task_t *task);
+void get_release_ring_stats(const release_ring_t *ring, release_ring_stats_t *stats);
+
+
+#endif
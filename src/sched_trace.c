@@ -0,0 +1,109 @@
+/**
+ * @file sched_trace.c
+ * @brief Binary trace of scheduler events in a RAM ring. Each event is one
+ *    fixed size record written in a few instructions, with no formatting and
+ *    no kernel call, so tracing does not disturb the schedule the way
+ *    printing lists does. Once the ring is full the oldest records are
+ *    overwritten, so a memory dump always holds the latest events. Records
+ *    can also be streamed to an ITM stimulus port. host/trace_decode.c turns
+ *    a dump or an SWO capture into a timeline.
+ *
+ *    Records are written by the DDS, the workers and possibly interrupts, so
+ *    each write masks the interrupts that may use the kernel for its
+ *    duration.
+ */
+
+#include "stm32f4xx.h"
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "sched_trace.h"
+#include "release_engine.h"
+
+#define SCHED_TRACE_MASK (SCHED_TRACE_SIZE - 1)
+
+#if ( SCHED_TRACE_ENABLE == 1 )
+
+sched_trace_buffer_t sched_trace_buffer;
+
+#if ( SCHED_TRACE_ITM == 1 ) && !defined(DD_SIM_BUILD)
+/**
+ * @brief Send a record to the ITM stimulus port, one word at a time. Waits
+ *        for room in the ITM FIFO, and does nothing while no debugger has
+ *        enabled the port.
+ *
+ * @param record (const sched_trace_record_t *) [IN] The record
+ * @return (void)
+ */
+static void sched_trace_itm(const sched_trace_record_t *record) {
+    const uint32_t *words = (const uint32_t *)record;
+    if ((ITM->TCR & ITM_TCR_ITMENA_Msk) == 0 || (ITM->TER & (1UL << SCHED_TRACE_ITM_PORT)) == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < sizeof(*record) / sizeof(uint32_t); i++) {
+        while (ITM->PORT[SCHED_TRACE_ITM_PORT].u32 == 0) {
+        }
+        ITM->PORT[SCHED_TRACE_ITM_PORT].u32 = words[i];
+    }
+}
+#endif
+
+/**
+ * @brief Record a scheduler event. Safe from a task or an ISR.
+ *
+ * @param event (sched_trace_event_t) [IN] The event
+ * @param task_id (uint32_t) [IN] Task id of the job
+ * @param user_task_id (uint32_t) [IN] User task the job belongs to
+ * @return (void)
+ */
+void sched_trace(sched_trace_event_t event, uint32_t task_id, uint32_t user_task_id) {
+    // Raises BASEPRI from a task as well, without the nesting count and the
+    // pending yield check of taskENTER_CRITICAL()
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    uint32_t head = sched_trace_buffer.head;
+    sched_trace_record_t *record = &sched_trace_buffer.records[head & SCHED_TRACE_MASK];
+    record->timestamp_us = get_release_engine_time_us();
+    record->task_id = task_id;
+    record->user_task_id = (uint16_t)user_task_id;
+    record->event = (uint8_t)event;
+    record->sequence = (uint8_t)head;
+    sched_trace_buffer.head = head + 1;
+#if ( SCHED_TRACE_ITM == 1 ) && !defined(DD_SIM_BUILD)
+    sched_trace_itm(record);
+#endif
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+#endif
+
+/**
+ * @brief Initialize the trace ring, empty. Called before any event.
+ *
+ * @return (void)
+ */
+void init_sched_trace(void) {
+#if ( SCHED_TRACE_ENABLE == 1 )
+    sched_trace_buffer.magic = SCHED_TRACE_MAGIC;
+    sched_trace_buffer.version = SCHED_TRACE_VERSION;
+    sched_trace_buffer.record_size = sizeof(sched_trace_record_t);
+    sched_trace_buffer.capacity = SCHED_TRACE_SIZE;
+    sched_trace_buffer.head = 0;
+#endif
+}
+
+/**
+ * @brief Copy the trace ring counters
+ *
+ * @param stats (sched_trace_stats_t *) [OUT] Where to copy the counters
+ * @return (void)
+ */
+void get_sched_trace_stats(sched_trace_stats_t *stats) {
+#if ( SCHED_TRACE_ENABLE == 1 )
+    uint32_t head = sched_trace_buffer.head;
+    stats->written = head;
+    stats->overwritten = head > SCHED_TRACE_SIZE ? head - SCHED_TRACE_SIZE : 0;
+#else
+    stats->written = 0;
+    stats->overwritten = 0;
+#endif
+}
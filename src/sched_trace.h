@@ -0,0 +1,135 @@
+#ifndef SCHED_TRACE_H
+#define SCHED_TRACE_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Set to 0 to compile every trace point out
+ */
+#ifndef SCHED_TRACE_ENABLE
+#define SCHED_TRACE_ENABLE 1
+#endif
+
+/**
+ * @brief Number of records the trace ring holds, must be a power of two.
+ *        Once full, the oldest records are overwritten.
+ */
+#ifndef SCHED_TRACE_SIZE
+#define SCHED_TRACE_SIZE 256
+#endif
+
+#if (SCHED_TRACE_SIZE & (SCHED_TRACE_SIZE - 1)) != 0
+#error "SCHED_TRACE_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Set to 1 to also send every record to ITM stimulus port
+ *        SCHED_TRACE_ITM_PORT, next to printf on port 0
+ */
+#ifndef SCHED_TRACE_ITM
+#define SCHED_TRACE_ITM 0
+#endif
+
+#ifndef SCHED_TRACE_ITM_PORT
+#define SCHED_TRACE_ITM_PORT 1
+#endif
+
+/**
+ * @brief Marks the start of a trace dump, "DDTR" in memory order
+ */
+#define SCHED_TRACE_MAGIC 0x52544444
+
+/**
+ * @brief Version of the dump and record layout, for the host decoder
+ */
+#define SCHED_TRACE_VERSION 1
+
+/**
+ * @brief Scheduler event of a trace record
+ *
+ * @param SCHED_TRACE_RELEASE The DDS added the job to the active list
+ * @param SCHED_TRACE_DISPATCH The job became the earliest deadline
+ * @param SCHED_TRACE_PREEMPT The job stopped being the earliest deadline before completing
+ * @param SCHED_TRACE_START The worker started running the job
+ * @param SCHED_TRACE_COMPLETE The worker finished running the job
+ * @param SCHED_TRACE_OVERDUE The DDS moved the job to the overdue list
+ * @param SCHED_TRACE_DROP The DDS dropped the release, no worker or active slot was free
+ * @param SCHED_TRACE_DDS_BEGIN The DDS woke up to handle an event, task ids are 0
+ * @param SCHED_TRACE_DDS_END The DDS is done and blocks again, task ids are 0
+ */
+typedef enum sched_trace_event {
+    SCHED_TRACE_RELEASE = 1,
+    SCHED_TRACE_DISPATCH,
+    SCHED_TRACE_PREEMPT,
+    SCHED_TRACE_START,
+    SCHED_TRACE_COMPLETE,
+    SCHED_TRACE_OVERDUE,
+    SCHED_TRACE_DROP,
+    SCHED_TRACE_DDS_BEGIN,
+    SCHED_TRACE_DDS_END
+} sched_trace_event_t;
+
+/**
+ * @brief Trace record, 12 bytes
+ *
+ * @param timestamp_us (uint32_t) Release engine time in microseconds, wraps every 71 minutes
+ * @param task_id (uint32_t) Task id of the job
+ * @param user_task_id (uint16_t) User task the job belongs to
+ * @param event (uint8_t) The sched_trace_event_t
+ * @param sequence (uint8_t) Low byte of the record number, shows gaps in a stream
+ */
+typedef struct sched_trace_record {
+    uint32_t timestamp_us;
+    uint32_t task_id;
+    uint16_t user_task_id;
+    uint8_t event;
+    uint8_t sequence;
+} sched_trace_record_t;
+
+/**
+ * @brief Trace ring in RAM. A dump of this struct is what the host decoder
+ *        reads, host/trace_decode.c.
+ *
+ * @param magic (uint32_t) SCHED_TRACE_MAGIC
+ * @param version (uint16_t) SCHED_TRACE_VERSION
+ * @param record_size (uint16_t) sizeof(sched_trace_record_t)
+ * @param capacity (uint32_t) SCHED_TRACE_SIZE
+ * @param head (uint32_t) Free running count of records written, the oldest
+ *        record left is head - capacity once the ring wrapped
+ * @param records (sched_trace_record_t[]) The records
+ */
+typedef struct sched_trace_buffer {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t capacity;
+    volatile uint32_t head;
+    sched_trace_record_t records[SCHED_TRACE_SIZE];
+} sched_trace_buffer_t;
+
+/**
+ * @brief Trace ring counters
+ *
+ * @param written (uint32_t) Records written since the start
+ * @param overwritten (uint32_t) Records lost to newer ones
+ */
+typedef struct sched_trace_stats {
+    uint32_t written;
+    uint32_t overwritten;
+} sched_trace_stats_t;
+
+
+extern sched_trace_buffer_t sched_trace_buffer;
+
+#if ( SCHED_TRACE_ENABLE == 1 )
+void sched_trace(sched_trace_event_t event, uint32_t task_id, uint32_t user_task_id);
+#else
+#define sched_trace(event, task_id, user_task_id) ((void)0)
+#endif
+void init_sched_trace(void);
+void get_sched_trace_stats(sched_trace_stats_t *stats);
+
+
+#endif
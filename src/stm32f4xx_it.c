@@ -27,6 +27,8 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_it.h"
+#include "release_engine.h"
+#include "uart_console.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -152,3 +154,27 @@ void DebugMon_Handler(void)
 {
 }*/
 
+/**
+  * @brief  This function handles TIM2 interrupt request, the periodic
+  *         release engine.
+  * @param  None
+  * @retval None
+  */
+void TIM2_IRQHandler(void)
+{
+  release_engine_irq_handler();
+}
+
+#if ( CONSOLE_USART == 1 )
+/**
+  * @brief  This function handles DMA1 Stream 6 interrupt request, the end
+  *         of a USART2 console transfer.
+  * @param  None
+  * @retval None
+  */
+void DMA1_Stream6_IRQHandler(void)
+{
+  uart_console_irq_handler();
+}
+#endif
+
@@ -38,6 +38,7 @@ SOFTWARE.
 #include <sys/time.h>
 #include <sys/times.h>
 #include "stm32f4xx.h"
+#include "uart_console.h"
 /* Variables */
 #undef errno
 extern int32_t errno;
@@ -77,10 +78,15 @@ void _exit(int32_t status)
 int _write(int file, char *ptr, int len)
 {
  /* Implement your write code here, this is used by
-puts and printf for example */
+puts and printf for example. The consoles are chosen in uart_console.h */
+#if ( CONSOLE_USART == 1 )
+ uart_console_write(ptr, len);
+#endif
+#if ( CONSOLE_ITM == 1 )
  int i=0;
  for(i=0 ; i<len ; i++)
-	 ITM_SendChar((*ptr++));
+	 ITM_SendChar(ptr[i]);
+#endif
  return len;
 }
 
@@ -0,0 +1,63 @@
+/**
+ * @file task_history.c
+ * @brief Fixed size circular history of completed or overdue DD-task jobs.
+ *    Pushing a job overwrites the oldest one once the history is full, so a
+ *    system running for weeks keeps the same memory footprint and never
+ *    takes nodes from the task pool. The total count keeps growing, so the
+ *    number of jobs no longer retained is total - DD_TASK_HISTORY_SIZE.
+ *
+ *    The DDS keeps the completed and the overdue histories in dd_snapshot
+ *    only for get_completed_dd_task_list() and get_overdue_dd_task_list().
+ *    The monitor reports the per task statistics of task_stats.c instead.
+ */
+
+#include "task_history.h"
+
+#define DD_TASK_HISTORY_MASK (DD_TASK_HISTORY_SIZE - 1)
+
+/**
+ * @brief Initialize an empty history
+ *
+ * @param history (dd_task_history_t *) [IN] The history
+ * @return (void)
+ */
+void init_task_history(dd_task_history_t *history) {
+    history->total = 0;
+}
+
+/**
+ * @brief Add a job, overwriting the oldest one if the history is full
+ *
+ * @param history (dd_task_history_t *) [IN] The history
+ * @param task (dd_task_t *) [IN] The job to copy in
+ * @return (void)
+ */
+void history_push(dd_task_history_t *history, const dd_task_t *task) {
+    history->records[history->total & DD_TASK_HISTORY_MASK] = *task;
+    history->total++;
+}
+
+/**
+ * @brief Number of jobs retained
+ *
+ * @param history (dd_task_history_t *) [IN] The history
+ * @return (uint32_t) At most DD_TASK_HISTORY_SIZE
+ */
+uint32_t history_size(const dd_task_history_t *history) {
+    return history->total < DD_TASK_HISTORY_SIZE ? history->total : DD_TASK_HISTORY_SIZE;
+}
+
+/**
+ * @brief Get a retained job, oldest first
+ *
+ * @param history (dd_task_history_t *) [IN] The history
+ * @param index (uint32_t) [IN] 0 for the oldest job retained
+ * @return (dd_task_t *) The job, NULL if index is not below history_size()
+ */
+const dd_task_t *history_get(const dd_task_history_t *history, uint32_t index) {
+    uint32_t size = history_size(history);
+    if (index >= size) {
+        return NULL;
+    }
+    return &history->records[(history->total - size + index) & DD_TASK_HISTORY_MASK];
+}
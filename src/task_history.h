@@ -0,0 +1,41 @@
+#ifndef TASK_HISTORY_H
+#define TASK_HISTORY_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "./linked_list.h"
+
+/**
+ * @brief Number of jobs a history keeps, must be a power of two. Older jobs
+ *        are overwritten, the memory taken is fixed at build time.
+ */
+#ifndef DD_TASK_HISTORY_SIZE
+#define DD_TASK_HISTORY_SIZE 32
+#endif
+
+#if (DD_TASK_HISTORY_SIZE & (DD_TASK_HISTORY_SIZE - 1)) != 0
+#error "DD_TASK_HISTORY_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Circular history of the last DD_TASK_HISTORY_SIZE completed or
+ *        overdue jobs. Written by the DDS only.
+ *
+ * @param records (dd_task_t[]) The jobs, record total & (size - 1) is the next one written
+ * @param total (uint32_t) Free running count of jobs ever pushed
+ */
+typedef struct dd_task_history {
+    dd_task_t records[DD_TASK_HISTORY_SIZE];
+    uint32_t total;
+} dd_task_history_t;
+
+
+void init_task_history(dd_task_history_t *history);
+void history_push(dd_task_history_t *history, const dd_task_t *task);
+uint32_t history_size(const dd_task_history_t *history);
+const dd_task_t *history_get(const dd_task_history_t *history, uint32_t index);
+
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TASK_SETS_H
+#define TASK_SETS_H
+
+/**
+ * @brief Test benches, shared by main.c and host/edf_sim.c so the simulated
+ *        sets are the ones flashed. Each bench is a list of rows
+ *        ENTRY(type, period, execution_time, relative_deadline, phase, led, workload)
+ *        expanded with the row macro of the includer: main.c builds its
+ *        dd_task_desc_t tables from them, edf_sim.c keeps the periodic rows.
+ *        All times are in ms, a relative deadline of 0 is the period.
+ */
+#define TEST_BENCH_1(ENTRY) \
+    ENTRY(PERIODIC,  500,  95, 0, 0, amber_led, WORKLOAD_INTEGER) \
+    ENTRY(PERIODIC,  500, 150, 0, 0, green_led, WORKLOAD_FPU) \
+    ENTRY(PERIODIC,  750, 250, 0, 0, red_led,   WORKLOAD_MEMORY)
+
+#define TEST_BENCH_2(ENTRY) \
+    ENTRY(PERIODIC,  250,  95, 0, 0, amber_led, WORKLOAD_INTEGER) \
+    ENTRY(PERIODIC,  500, 150, 0, 0, green_led, WORKLOAD_FPU) \
+    ENTRY(PERIODIC,  750, 250, 0, 0, red_led,   WORKLOAD_MEMORY)
+
+#define TEST_BENCH_3(ENTRY) \
+    ENTRY(PERIODIC,  500, 100, 0, 0, amber_led, WORKLOAD_INTEGER) \
+    ENTRY(PERIODIC,  500, 200, 0, 0, green_led, WORKLOAD_FPU) \
+    ENTRY(PERIODIC,  500, 200, 0, 0, red_led,   WORKLOAD_MEMORY)
+
+/* Test bench 1 plus an aperiodic task served by the TBS, the first three
+are the baseline sets of test1_out.txt to test3_out.txt. */
+#define TEST_BENCH_4(ENTRY) \
+    TEST_BENCH_1(ENTRY) \
+    ENTRY(APERIODIC, 400,  20, 0, 0, blue_led,  WORKLOAD_INTEGER)
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file task_snapshot.c
+ * @brief Sequence lock around the scheduler state the DDS publishes. The DDS
+ *    makes the sequence odd before changing the snapshot and even again
+ *    once done, a reader copies what it needs and starts over if the
+ *    sequence was odd or changed during the copy. Readers hold only copies
+ *    of tasks, never pointers to pool nodes, so nothing they look at can be
+ *    freed under them, and the DDS never waits for a reader.
+ *
+ *    Readers must be tasks that cannot preempt the DDS in the middle of an
+ *    update, or they would spin forever: no ISR and no task above the DDS,
+ *    the timer daemon included. The DDS only raises the monitor above
+ *    itself once the update is done.
+ */
+
+#include "task_snapshot.h"
+#include "dd_log.h"
+
+/* Keep the snapshot accesses between the two sequence updates, also emits a
+dmb on the Cortex-M4. */
+#define snapshot_barrier() __sync_synchronize()
+
+/**
+ * @brief Initialize an empty snapshot
+ *
+ * @param snapshot (dd_snapshot_t *) [IN] The snapshot
+ * @return (void)
+ */
+void init_snapshot(dd_snapshot_t *snapshot) {
+    snapshot->sequence = 0;
+    snapshot->active.size = 0;
+    init_task_history(&snapshot->completed);
+    init_task_history(&snapshot->overdue);
+}
+
+/**
+ * @brief Start changing the snapshot. Writer (the DDS) only.
+ *
+ * @param snapshot (dd_snapshot_t *) [IN] The snapshot
+ * @return (void)
+ */
+void snapshot_write_begin(dd_snapshot_t *snapshot) {
+    snapshot->sequence++;
+    snapshot_barrier();
+}
+
+/**
+ * @brief Done changing the snapshot. Writer (the DDS) only.
+ *
+ * @param snapshot (dd_snapshot_t *) [IN] The snapshot
+ * @return (void)
+ */
+void snapshot_write_end(dd_snapshot_t *snapshot) {
+    snapshot_barrier();
+    snapshot->sequence++;
+}
+
+/**
+ * @brief Copy the active tasks of a heap into the snapshot. Writer only,
+ *        between snapshot_write_begin() and snapshot_write_end().
+ *
+ * @param snapshot (dd_snapshot_t *) [IN] The snapshot
+ * @param heap (dd_task_heap_t *) [IN] The active task heap
+ * @return (void)
+ */
+void snapshot_set_active(dd_snapshot_t *snapshot, dd_task_heap_t *heap) {
+    uint32_t size = heap->size < DD_SNAPSHOT_MAX_ACTIVE ? (uint32_t)heap->size : DD_SNAPSHOT_MAX_ACTIVE;
+    for (uint32_t i = 0; i < size; i++) {
+        snapshot->active.tasks[i] = heap->nodes[i]->task;
+    }
+    snapshot->active.size = size;
+}
+
+/**
+ * @brief Copy a consistent view of the snapshot. Only the active tasks
+ *        actually in use are copied.
+ *
+ * @param snapshot (dd_snapshot_t *) [IN] The snapshot
+ * @param active (dd_active_tasks_t *) [OUT] Where to copy the active tasks, NULL to skip
+ * @param completed (dd_task_history_t *) [OUT] Where to copy the completed history, NULL to skip
+ * @param overdue (dd_task_history_t *) [OUT] Where to copy the overdue history, NULL to skip
+ * @return (void)
+ */
+void snapshot_read(const dd_snapshot_t *snapshot, dd_active_tasks_t *active,
+    dd_task_history_t *completed, dd_task_history_t *overdue) {
+    uint32_t sequence;
+    do {
+        sequence = snapshot->sequence;
+        snapshot_barrier();
+        if (sequence & 1) {
+            continue;
+        }
+        if (active != NULL) {
+            uint32_t size = snapshot->active.size;
+            if (size > DD_SNAPSHOT_MAX_ACTIVE) {
+                size = DD_SNAPSHOT_MAX_ACTIVE;
+            }
+            for (uint32_t i = 0; i < size; i++) {
+                active->tasks[i] = snapshot->active.tasks[i];
+            }
+            active->size = size;
+        }
+        if (completed != NULL) {
+            *completed = snapshot->completed;
+        }
+        if (overdue != NULL) {
+            *overdue = snapshot->overdue;
+        }
+        snapshot_barrier();
+    } while ((sequence & 1) || snapshot->sequence != sequence);
+}
+
+/**
+ * @brief Log the active tasks, in the print_heap() layout, one record per
+ *        line
+ *
+ * @param active (dd_active_tasks_t *) [IN] The active tasks
+ * @param active_name (const char *) [IN] Name logged in the header, must outlive the record
+ * @return (void)
+ */
+void log_active_tasks(const dd_active_tasks_t *active, const char *active_name) {
+    dd_log("%s task list: (size: %u)\n", active_name, (unsigned)active->size);
+
+    dd_log(DD_TASK_LIST_HEADER);
+    for (uint32_t i = 0; i < active->size; i++) {
+        const dd_task_t *task = &active->tasks[i];
+        dd_log(DD_TASK_LIST_ROW, (unsigned)task->user_task_id, DD_TASK_TICKS_TO_MS(task->release_time),
+            DD_TASK_TICKS_TO_MS(task->absolute_deadline), DD_TASK_TICKS_TO_MS(task->completion_time));
+    }
+}
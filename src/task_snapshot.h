@@ -0,0 +1,58 @@
+#ifndef TASK_SNAPSHOT_H
+#define TASK_SNAPSHOT_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "./linked_list.h"
+#include "./task_history.h"
+
+/**
+ * @brief Number of active tasks the snapshot holds, at least the capacity of
+ *        the DDS active task heap
+ */
+#ifndef DD_SNAPSHOT_MAX_ACTIVE
+#define DD_SNAPSHOT_MAX_ACTIVE 100
+#endif
+
+/**
+ * @brief Copy of the active tasks, in heap order (earliest deadline first)
+ *
+ * @param size (uint32_t) Number of tasks
+ * @param tasks (dd_task_t[]) The tasks
+ */
+typedef struct dd_active_tasks {
+    uint32_t size;
+    dd_task_t tasks[DD_SNAPSHOT_MAX_ACTIVE];
+} dd_active_tasks_t;
+
+/**
+ * @brief Scheduler state published by the DDS. The DDS is the only writer,
+ *        readers copy it out without waking the DDS and retry if it was
+ *        written meanwhile. The DDS only copies the active tasks in when
+ *        it wakes the monitor, the histories on every event.
+ *
+ * @param sequence (uint32_t) Odd while the DDS is writing, bumped by two per update
+ * @param active (dd_active_tasks_t) The active tasks
+ * @param completed (dd_task_history_t) The last completed tasks
+ * @param overdue (dd_task_history_t) The last overdue tasks
+ */
+typedef struct dd_snapshot {
+    volatile uint32_t sequence;
+    dd_active_tasks_t active;
+    dd_task_history_t completed;
+    dd_task_history_t overdue;
+} dd_snapshot_t;
+
+
+void init_snapshot(dd_snapshot_t *snapshot);
+void snapshot_write_begin(dd_snapshot_t *snapshot);
+void snapshot_write_end(dd_snapshot_t *snapshot);
+void snapshot_set_active(dd_snapshot_t *snapshot, dd_task_heap_t *heap);
+void snapshot_read(const dd_snapshot_t *snapshot, dd_active_tasks_t *active,
+    dd_task_history_t *completed, dd_task_history_t *overdue);
+void log_active_tasks(const dd_active_tasks_t *active, const char *active_name);
+
+
+#endif
@@ -0,0 +1,149 @@
+/**
+ * @file task_stats.c
+ * @brief Per user task statistics of the DD-task jobs. The DDS adds each job
+ *    as it completes, is found overdue or is dropped, in constant time, so reading the
+ *    statistics costs the same however long the system has run, unlike
+ *    walking the completed and overdue lists.
+ *
+ *    The task_stats_record_*() functions must be called from the DDS only.
+ */
+
+#include <stddef.h>
+
+#include "task_stats.h"
+
+/**
+ * @brief Statistics of a task, and the sum behind the mean
+ *
+ * @param response_total (uint64_t) Sum of the response times
+ * @param stats (task_stats_t) The statistics
+ */
+typedef struct task_stats_entry {
+    uint64_t response_total;
+    task_stats_t stats;
+} task_stats_entry_t;
+
+static task_stats_entry_t task_stats_entries[TASK_STATS_MAX_TASKS];
+// Jobs of user task ids that have no entry
+static uint32_t task_stats_untracked = 0;
+
+/**
+ * @brief Count a job that ended, on time or not
+ *
+ * @param user_task_id (uint32_t) [IN] User task the job belongs to
+ * @param lateness (int32_t) [IN] End time minus deadline, in ticks
+ * @param missed (bool) [IN] The job was overdue
+ * @return (task_stats_entry_t *) The entry of the task, NULL if the id has none
+ */
+static task_stats_entry_t *record_job(uint32_t user_task_id, int32_t lateness, bool missed) {
+    if (user_task_id == 0 || user_task_id > TASK_STATS_MAX_TASKS) {
+        task_stats_untracked++;
+        return NULL;
+    }
+    task_stats_entry_t *entry = &task_stats_entries[user_task_id - 1];
+    task_stats_t *stats = &entry->stats;
+
+    // Dropped jobs have no lateness
+    if (stats->jobs == stats->dropped || lateness > stats->max_lateness) {
+        stats->max_lateness = lateness;
+    }
+    uint32_t bucket = 0;
+    if (lateness > 0) {
+        bucket = 1;
+        while (bucket < TASK_STATS_LATENESS_BUCKETS - 1 && ((uint32_t)lateness >> bucket) != 0) {
+            bucket++;
+        }
+    }
+    stats->lateness_histogram[bucket]++;
+    stats->user_task_id = user_task_id;
+    stats->jobs++;
+    if (missed) {
+        stats->missed++;
+    }
+    return entry;
+}
+
+/**
+ * @brief Count a job that completed
+ *
+ * @param user_task_id (uint32_t) [IN] User task the job belongs to
+ * @param release_time (uint32_t) [IN] Release time of the job in ticks
+ * @param absolute_deadline (uint32_t) [IN] Deadline of the job in ticks
+ * @param completion_time (uint32_t) [IN] Completion time of the job in ticks
+ * @return (void)
+ */
+void task_stats_record_completion(uint32_t user_task_id, uint32_t release_time,
+    uint32_t absolute_deadline, uint32_t completion_time) {
+    task_stats_entry_t *entry = record_job(user_task_id,
+        (int32_t)(completion_time - absolute_deadline), false);
+    if (entry == NULL) {
+        return;
+    }
+    task_stats_t *stats = &entry->stats;
+    uint32_t response_time = completion_time - release_time;
+    if (stats->completed == 0 || response_time < stats->response_min) {
+        stats->response_min = response_time;
+    }
+    if (response_time > stats->response_max) {
+        stats->response_max = response_time;
+    }
+    stats->completed++;
+    entry->response_total += response_time;
+    stats->response_mean = (uint32_t)(entry->response_total / stats->completed);
+}
+
+/**
+ * @brief Count a job that was found overdue
+ *
+ * @param user_task_id (uint32_t) [IN] User task the job belongs to
+ * @param absolute_deadline (uint32_t) [IN] Deadline of the job in ticks
+ * @param now (uint32_t) [IN] Time the job was found overdue, in ticks
+ * @return (void)
+ */
+void task_stats_record_overdue(uint32_t user_task_id, uint32_t absolute_deadline, uint32_t now) {
+    record_job(user_task_id, (int32_t)(now - absolute_deadline), true);
+}
+
+/**
+ * @brief Count a job dropped at release, a miss that has no lateness since
+ *        the job never ran
+ *
+ * @param user_task_id (uint32_t) [IN] User task the job belongs to
+ * @return (void)
+ */
+void task_stats_record_drop(uint32_t user_task_id) {
+    if (user_task_id == 0 || user_task_id > TASK_STATS_MAX_TASKS) {
+        task_stats_untracked++;
+        return;
+    }
+    task_stats_t *stats = &task_stats_entries[user_task_id - 1].stats;
+    stats->user_task_id = user_task_id;
+    stats->jobs++;
+    stats->missed++;
+    stats->dropped++;
+}
+
+/**
+ * @brief Copy the statistics of a task
+ *
+ * @param index (uint32_t) [IN] User task id minus one
+ * @param stats (task_stats_t *) [OUT] Where to copy the statistics
+ * @return (bool) false if index is not below TASK_STATS_MAX_TASKS
+ */
+bool get_task_stats(uint32_t index, task_stats_t *stats) {
+    if (index >= TASK_STATS_MAX_TASKS) {
+        return false;
+    }
+    *stats = task_stats_entries[index].stats;
+    return true;
+}
+
+/**
+ * @brief Number of jobs whose user task id is 0 or above
+ *        TASK_STATS_MAX_TASKS, counted but without statistics
+ *
+ * @return (uint32_t) Jobs
+ */
+uint32_t get_task_stats_untracked(void) {
+    return task_stats_untracked;
+}
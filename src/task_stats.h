@@ -0,0 +1,62 @@
+#ifndef TASK_STATS_H
+#define TASK_STATS_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of user tasks with statistics, user task ids 1 to this. As
+ *        many as the release engine and the admission control take. Jobs of
+ *        other ids are only counted, see get_task_stats_untracked().
+ */
+#ifndef TASK_STATS_MAX_TASKS
+#define TASK_STATS_MAX_TASKS 64
+#endif
+
+/**
+ * @brief Number of lateness histogram buckets. Bucket 0 counts the jobs on
+ *        time, bucket i the jobs 2^(i-1) to 2^i - 1 ticks late, and the last
+ *        one every job later than that.
+ */
+#define TASK_STATS_LATENESS_BUCKETS 8
+
+/**
+ * @brief Running statistics of the jobs of a user task, updated when a job
+ *        completes, is found overdue or is dropped
+ *
+ * @param user_task_id (uint32_t) The user task id, 0 if no job ended yet
+ * @param jobs (uint32_t) Jobs that completed, were overdue or were dropped
+ * @param completed (uint32_t) Jobs that completed
+ * @param missed (uint32_t) Jobs that were overdue or were dropped
+ * @param dropped (uint32_t) Jobs dropped at release, they never ran
+ * @param response_min (uint32_t) Shortest response time of a completed job, in ticks
+ * @param response_max (uint32_t) Longest response time of a completed job, in ticks
+ * @param response_mean (uint32_t) Mean response time of the completed jobs, in ticks
+ * @param max_lateness (int32_t) Largest end time minus deadline, in ticks. Negative
+ *        while every job was on time, it is then minus the smallest slack.
+ * @param lateness_histogram (uint32_t[]) Jobs per lateness bucket
+ */
+typedef struct task_stats {
+    uint32_t user_task_id;
+    uint32_t jobs;
+    uint32_t completed;
+    uint32_t missed;
+    uint32_t dropped;
+    uint32_t response_min;
+    uint32_t response_max;
+    uint32_t response_mean;
+    int32_t max_lateness;
+    uint32_t lateness_histogram[TASK_STATS_LATENESS_BUCKETS];
+} task_stats_t;
+
+
+void task_stats_record_completion(uint32_t user_task_id, uint32_t release_time,
+    uint32_t absolute_deadline, uint32_t completion_time);
+void task_stats_record_overdue(uint32_t user_task_id, uint32_t absolute_deadline, uint32_t now);
+void task_stats_record_drop(uint32_t user_task_id);
+bool get_task_stats(uint32_t index, task_stats_t *stats);
+uint32_t get_task_stats_untracked(void);
+
+
+#endif
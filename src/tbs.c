@@ -0,0 +1,98 @@
+/**
+ * @file tbs.c
+ * @brief Total Bandwidth Server for aperiodic DD-tasks. Each aperiodic job is
+ *    given the deadline d_k = max(r_k, d_k-1) + C_k / U_s, where U_s is the
+ *    server bandwidth. The job then competes with the periodic jobs in EDF
+ *    order, and the aperiodic load can never take more than U_s of the
+ *    processor. If the periodic utilization plus U_s is at most 100%, every
+ *    periodic deadline and every assigned aperiodic deadline is met, however
+ *    bursty the aperiodic arrivals are.
+ *
+ *    tbs_assign_deadline() must be called from the releasing context only,
+ *    and tbs_record_completion() and tbs_record_overdue() from the DDS only.
+ *    last_deadline is never rolled back, so a deadline must only be assigned
+ *    to a job that is sure to be queued for the server.
+ */
+
+#include "tbs.h"
+
+#define PPM 1000000ULL
+
+static uint32_t last_deadline = 0;
+static uint64_t response_total = 0;
+static tbs_stats_t tbs_stats = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+/**
+ * @brief Start the server with a bandwidth. The bandwidth must have been
+ *        reserved with the admission control beforehand.
+ *
+ * @param bandwidth_ppm (uint32_t) [IN] Server bandwidth in ppm, 0 to turn the server off
+ * @return (void)
+ */
+void tbs_init(uint32_t bandwidth_ppm) {
+    tbs_stats.bandwidth_ppm = bandwidth_ppm > PPM ? (uint32_t)PPM : bandwidth_ppm;
+}
+
+/**
+ * @brief Assign the deadline of an aperiodic job. Deadlines of successive
+ *        jobs never decrease, so jobs are served in arrival order.
+ *
+ * @param release_time (uint32_t) [IN] Release time of the job in ticks
+ * @param execution_time (uint32_t) [IN] Worst case execution time of the job in ticks
+ * @param absolute_deadline (uint32_t *) [OUT] The assigned deadline in ticks
+ * @return (bool) false if the server is off
+ */
+bool tbs_assign_deadline(uint32_t release_time, uint32_t execution_time,
+    uint32_t *absolute_deadline) {
+    if (tbs_stats.bandwidth_ppm == 0) {
+        return false;
+    }
+    // Ticks wrap, so compare the difference, and the first job has no
+    // previous deadline to compare with
+    uint32_t start = tbs_stats.released == 0 || (int32_t)(release_time - last_deadline) > 0
+        ? release_time : last_deadline;
+    // Round the budget up so the server never exceeds its bandwidth
+    uint64_t budget = ((uint64_t)execution_time * PPM + tbs_stats.bandwidth_ppm - 1) / tbs_stats.bandwidth_ppm;
+    last_deadline = start + (uint32_t)budget;
+    *absolute_deadline = last_deadline;
+    tbs_stats.last_deadline = last_deadline;
+    tbs_stats.released++;
+    return true;
+}
+
+/**
+ * @brief Count an aperiodic job that completed
+ *
+ * @param response_time (uint32_t) [IN] Completion time minus release time, in ticks
+ * @return (void)
+ */
+void tbs_record_completion(uint32_t response_time) {
+    if (tbs_stats.completed == 0 || response_time < tbs_stats.response_min) {
+        tbs_stats.response_min = response_time;
+    }
+    if (response_time > tbs_stats.response_max) {
+        tbs_stats.response_max = response_time;
+    }
+    tbs_stats.completed++;
+    response_total += response_time;
+    tbs_stats.response_mean = (uint32_t)(response_total / tbs_stats.completed);
+}
+
+/**
+ * @brief Count an aperiodic job that missed its deadline
+ *
+ * @return (void)
+ */
+void tbs_record_overdue(void) {
+    tbs_stats.overdue++;
+}
+
+/**
+ * @brief Copy the server counters
+ *
+ * @param stats (tbs_stats_t *) [OUT] Where to copy the counters
+ * @return (void)
+ */
+void get_tbs_stats(tbs_stats_t *stats) {
+    *stats = tbs_stats;
+}
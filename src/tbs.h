@@ -0,0 +1,40 @@
+#ifndef TBS_H
+#define TBS_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Aperiodic job counters of the Total Bandwidth Server
+ *
+ * @param bandwidth_ppm (uint32_t) Server bandwidth in parts per million, 0 if the server is off
+ * @param last_deadline (uint32_t) Deadline assigned to the last served job, in ticks
+ * @param released (uint32_t) Number of aperiodic jobs given a deadline
+ * @param completed (uint32_t) Number of aperiodic jobs that completed
+ * @param overdue (uint32_t) Number of aperiodic jobs that missed their deadline
+ * @param response_min (uint32_t) Shortest response time of a completed job, in ticks
+ * @param response_max (uint32_t) Longest response time of a completed job, in ticks
+ * @param response_mean (uint32_t) Mean response time of the completed jobs, in ticks
+ */
+typedef struct tbs_stats {
+    uint32_t bandwidth_ppm;
+    uint32_t last_deadline;
+    uint32_t released;
+    uint32_t completed;
+    uint32_t overdue;
+    uint32_t response_min;
+    uint32_t response_max;
+    uint32_t response_mean;
+} tbs_stats_t;
+
+
+void tbs_init(uint32_t bandwidth_ppm);
+bool tbs_assign_deadline(uint32_t release_time, uint32_t execution_time,
+    uint32_t *absolute_deadline);
+void tbs_record_completion(uint32_t response_time);
+void tbs_record_overdue(void);
+void get_tbs_stats(tbs_stats_t *stats);
+
+
+#endif
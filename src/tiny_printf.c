@@ -21,8 +21,17 @@
 **                x,X  unsigned integer as hexadecimal (uppercase letter)
 **                %    % is written (conversion specification is '%%')
 **
+**                A minimum field width may come before the specifier,
+**                padded with spaces on the left. Flags before the width:
+**                -    pad on the right instead
+**                0    pad numbers with zeros, after the sign
+**
 **                Note:
-**                Character padding is not supported
+**                The format is walked once. printf and fprintf stream the
+**                output through a TS_CHUNK_SIZE byte buffer on the stack to
+**                _write, so the stack used does not depend on the length
+**                of the output. snprintf and vsnprintf never write past
+**                the size they are given.
 **
 **  Environment : Atollic TrueSTUDIO
 **
@@ -42,159 +51,252 @@
 
 /* Includes */
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 
+/* Bytes formatted before each _write call of printf and fprintf */
+#ifndef TS_CHUNK_SIZE
+#define TS_CHUNK_SIZE 64
+#endif
+
 /* External function prototypes (defined in syscalls.c) */
 extern int _write(int fd, char *str, int len);
 
+/* Private types */
+
+/* Where the formatted characters go. With fd >= 0 buf is a chunk written
+   out to _write when full, otherwise it is the caller's string and size
+   leaves room for the terminating 0. */
+typedef struct
+{
+	char *buf;
+	size_t size;
+	size_t len;
+	int written;
+	int lost;
+	int fd;
+} ts_out_t;
+
 /* Private function prototypes */
-void ts_itoa(char **buf, unsigned int d, int base);
-int ts_formatstring(char *buf, const char *fmt, va_list va);
-int ts_formatlength(const char *fmt, va_list va);
+static inline void ts_putc(ts_out_t *out, char c);
+static void ts_pad(ts_out_t *out, char c, int count);
+static void ts_flush(ts_out_t *out);
+static int ts_full(ts_out_t *out);
+static inline int ts_total(const ts_out_t *out);
+static void ts_format(ts_out_t *out, const char *fmt, va_list va);
 
 /* Private functions */
 
 /**
 **---------------------------------------------------------------------------
-**  Abstract: Convert integer to ascii
+**  Abstract: Write out the chunk buffer of a streamed output
 **  Returns:  void
 **---------------------------------------------------------------------------
 */
-void ts_itoa(char **buf, unsigned int d, int base)
+static void ts_flush(ts_out_t *out)
 {
-	int div = 1;
-	while (d/div >= base)
-		div *= base;
-
-	while (div != 0)
+	if (out->len > 0)
 	{
-		int num = d/div;
-		d = d%div;
-		div /= base;
-		if (num > 9)
-			*((*buf)++) = (num-10) + 'A';
-		else
-			*((*buf)++) = num + '0';
+		_write(out->fd, out->buf, (int)out->len);
+		out->written += (int)out->len;
+		out->len = 0;
 	}
 }
 
 /**
 **---------------------------------------------------------------------------
-**  Abstract: Writes arguments va to buffer buf according to format fmt
-**  Returns:  Length of string
+**  Abstract: Make room in a full output. A chunk is written out, a string
+**            has no room left and the character is only counted.
+**  Returns:  1 if the character can be stored
 **---------------------------------------------------------------------------
 */
-int ts_formatstring(char *buf, const char *fmt, va_list va)
+static int ts_full(ts_out_t *out)
 {
-	char *start_buf = buf;
-	while(*fmt)
+	if (out->fd < 0)
 	{
-		/* Character needs formating? */
-		if (*fmt == '%')
-		{
-			switch (*(++fmt))
-			{
-			  case 'c':
-				*buf++ = va_arg(va, int);
-				break;
-			  case 'd':
-			  case 'i':
-				{
-					signed int val = va_arg(va, signed int);
-					if (val < 0)
-					{
-						val *= -1;
-						*buf++ = '-';
-					}
-					ts_itoa(&buf, val, 10);
-				}
-				break;
-			  case 's':
-				{
-					char * arg = va_arg(va, char *);
-					while (*arg)
-					{
-						*buf++ = *arg++;
-					}
-				}
-				break;
-			  case 'u':
-					ts_itoa(&buf, va_arg(va, unsigned int), 10);
-				break;
-			  case 'x':
-			  case 'X':
-					ts_itoa(&buf, va_arg(va, int), 16);
-				break;
-			  case '%':
-				  *buf++ = '%';
-				  break;
-			}
-			fmt++;
-		}
-		/* Else just copy */
-		else
-		{
-			*buf++ = *fmt++;
-		}
+		out->lost++;
+		return 0;
 	}
-	*buf = 0;
+	ts_flush(out);
+	return 1;
+}
 
-	return (int)(buf - start_buf);
+/**
+**---------------------------------------------------------------------------
+**  Abstract: Add a character to the output
+**  Returns:  void
+**---------------------------------------------------------------------------
+*/
+static inline void ts_putc(ts_out_t *out, char c)
+{
+	if (out->len == out->size && !ts_full(out))
+		return;
+	out->buf[out->len++] = c;
+}
+
+/**
+**---------------------------------------------------------------------------
+**  Abstract: Number of characters the output has received
+**  Returns:  The count, stored or not
+**---------------------------------------------------------------------------
+*/
+static inline int ts_total(const ts_out_t *out)
+{
+	return out->written + (int)out->len + out->lost;
 }
 
+/**
+**---------------------------------------------------------------------------
+**  Abstract: Add count copies of a character to the output
+**  Returns:  void
+**---------------------------------------------------------------------------
+*/
+static void ts_pad(ts_out_t *out, char c, int count)
+{
+	while (count-- > 0)
+		ts_putc(out, c);
+}
 
 /**
 **---------------------------------------------------------------------------
-**  Abstract: Calculate maximum length of the resulting string from the
-**            format string and va_list va
-**  Returns:  Maximum length
+**  Abstract: Writes arguments va to the output according to format fmt,
+**            in a single pass over fmt
+**  Returns:  void
 **---------------------------------------------------------------------------
 */
-int ts_formatlength(const char *fmt, va_list va)
+static void ts_format(ts_out_t *out, const char *fmt, va_list va)
 {
-	int length = 0;
 	while (*fmt)
 	{
-		if (*fmt == '%')
+		/* Character needs formating? */
+		if (*fmt != '%')
 		{
-			++fmt;
-			switch (*fmt)
-			{
-			  case 'c':
-		  		  va_arg(va, int);
-				  ++length;
-				  break;
-			  case 'd':
-			  case 'i':
-			  case 'u':
-				  /* 32 bits integer is max 11 characters with minus sign */
-				  length += 11;
-				  va_arg(va, int);
-				  break;
-			  case 's':
-			  	  {
-			  		  char * str = va_arg(va, char *);
-			  		  while (*str++)
-			  			  ++length;
-			  	  }
-				  break;
-			  case 'x':
-			  case 'X':
-				  /* 32 bits integer as hex is max 8 characters */
-				  length += 8;
-				  va_arg(va, unsigned int);
-				  break;
-			  default:
-				  ++length;
-				  break;
-			}
+			ts_putc(out, *fmt++);
+			continue;
+		}
+		fmt++;
+
+		int left = 0;
+		char pad = ' ';
+		for (;; fmt++)
+		{
+			if (*fmt == '-')
+				left = 1;
+			else if (*fmt == '0')
+				pad = '0';
+			else
+				break;
 		}
-		else
+		int width = 0;
+		while (*fmt >= '0' && *fmt <= '9')
+			width = width * 10 + (*fmt++ - '0');
+		if (left)
+			pad = ' ';
+
+		/* Digits are produced backwards, 32 bits are at most 10 of them */
+		char digits[10];
+		int count = 0;
+		int negative = 0;
+		unsigned int val;
+		unsigned int base = 10;
+
+		switch (*fmt)
 		{
-			++length;
+		  case 'c':
+			ts_pad(out, ' ', left ? 0 : width - 1);
+			ts_putc(out, (char)va_arg(va, int));
+			ts_pad(out, ' ', left ? width - 1 : 0);
+			break;
+		  case 's':
+			{
+				const char *arg = va_arg(va, const char *);
+				int length = 0;
+				while (arg[length])
+					length++;
+				ts_pad(out, ' ', left ? 0 : width - length);
+				while (*arg)
+					ts_putc(out, *arg++);
+				ts_pad(out, ' ', left ? width - length : 0);
+			}
+			break;
+		  case 'd':
+		  case 'i':
+			{
+				signed int sval = va_arg(va, signed int);
+				negative = sval < 0;
+				val = negative ? 0U - (unsigned int)sval : (unsigned int)sval;
+			}
+			goto number;
+		  case 'x':
+		  case 'X':
+			base = 16;
+			/* fall through */
+		  case 'u':
+			val = va_arg(va, unsigned int);
+		  number:
+			do
+			{
+				unsigned int num = val % base;
+				val /= base;
+				digits[count++] = (char)(num > 9 ? (num - 10) + 'A' : num + '0');
+			} while (val != 0);
+			width -= count + negative;
+			if (!left && pad == ' ')
+				ts_pad(out, ' ', width);
+			if (negative)
+				ts_putc(out, '-');
+			if (!left && pad == '0')
+				ts_pad(out, '0', width);
+			while (count > 0)
+				ts_putc(out, digits[--count]);
+			if (left)
+				ts_pad(out, ' ', width);
+			break;
+		  case '%':
+			ts_putc(out, '%');
+			break;
+		  case '\0':
+			/* Format ends with a lone % */
+			return;
 		}
-		++fmt;
+		fmt++;
 	}
+}
+
+/**
+**===========================================================================
+**  Abstract: Loads data from the given locations and writes them to the
+**            given character string according to the format parameter,
+**            at most size characters including the terminating 0.
+**  Returns:  Number of characters the whole output has, without the
+**            terminating 0, even if it was cut
+**===========================================================================
+*/
+int vsnprintf(char *buf, size_t size, const char *fmt, va_list va)
+{
+	ts_out_t out = { buf, size > 0 ? size - 1 : 0, 0, 0, 0, -1 };
+	ts_format(&out, fmt, va);
+	if (size > 0)
+		buf[out.len] = 0;
+	return ts_total(&out);
+}
+
+/**
+**===========================================================================
+**  Abstract: Loads data from the given locations and writes them to the
+**            given character string according to the format parameter,
+**            at most size characters including the terminating 0.
+**  Returns:  Number of characters the whole output has, without the
+**            terminating 0, even if it was cut
+**===========================================================================
+*/
+int snprintf(char *buf, size_t size, const char *fmt, ...)
+{
+	int length;
+	va_list va;
+	va_start(va, fmt);
+	length = vsnprintf(buf, size, fmt, va);
+	va_end(va);
 	return length;
 }
 
@@ -210,7 +312,7 @@ int sprintf(char *buf, const char *fmt, ...)
 	int length;
 	va_list va;
 	va_start(va, fmt);
-	length = ts_formatstring(buf, fmt, va);
+	length = vsnprintf(buf, (size_t)-1 / 2, fmt, va);
 	va_end(va);
 	return length;
 }
@@ -224,19 +326,14 @@ int sprintf(char *buf, const char *fmt, ...)
 */
 int fprintf(FILE * stream, const char *fmt, ...)
 {
-	int length = 0;
+	char chunk[TS_CHUNK_SIZE];
+	ts_out_t out = { chunk, sizeof(chunk), 0, 0, 0, stream->_file };
 	va_list va;
 	va_start(va, fmt);
-	length = ts_formatlength(fmt, va);
+	ts_format(&out, fmt, va);
 	va_end(va);
-	{
-		char buf[length];
-		va_start(va, fmt);
-		length = ts_formatstring(buf, fmt, va);
-		length = _write(stream->_file, buf, length);
-		va_end(va);
-	}
-	return length;
+	ts_flush(&out);
+	return out.written;
 }
 
 /**
@@ -249,18 +346,12 @@ int fprintf(FILE * stream, const char *fmt, ...)
 */
 int printf(const char *fmt, ...)
 {
-	int length = 0;
+	char chunk[TS_CHUNK_SIZE];
+	ts_out_t out = { chunk, sizeof(chunk), 0, 0, 0, 1 };
 	va_list va;
 	va_start(va, fmt);
-	length = ts_formatlength(fmt, va);
+	ts_format(&out, fmt, va);
 	va_end(va);
-	{
-		char buf[length];
-		va_start(va, fmt);
-		length = ts_formatstring(buf, fmt, va);
-		length = _write(1, buf, length);
-		va_end(va);
-	}
-	return length;
+	ts_flush(&out);
+	return out.written;
 }
-
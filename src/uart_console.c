@@ -0,0 +1,193 @@
+/**
+ * @file uart_console.c
+ * @brief printf console on USART2, sent by DMA. Writers copy into one of two
+ *    buffers while DMA1 stream 6 sends the other, and the transfer complete
+ *    interrupt starts the next buffer, so the CPU never waits per byte and
+ *    no debugger is needed. A task that writes more than fits blocks until
+ *    the transfer complete interrupt notifies it that a buffer is free, so
+ *    the log task prints whole reports however small the buffers. Only an
+ *    ISR, or code run while the scheduler is not running, loses the bytes
+ *    that do not fit, and counts them.
+ *
+ *    The buffers are only touched with the interrupts that may use the
+ *    kernel masked, which also masks the DMA interrupt, for the time of a
+ *    copy into RAM. Only built in with CONSOLE_USART set to 1.
+ */
+
+#include <string.h>
+
+#include "stm32f4xx.h"
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "../FreeRTOS_Source/include/semphr.h"
+
+#include "uart_console.h"
+
+#if ( CONSOLE_USART == 1 )
+
+#define UART_CONSOLE_DMA_FLAGS (DMA_FLAG_TCIF6 | DMA_FLAG_HTIF6 | DMA_FLAG_TEIF6 | DMA_FLAG_DMEIF6 | DMA_FLAG_FEIF6)
+
+static uint8_t tx_buffers[2][UART_CONSOLE_BUFFER_SIZE];
+static uint32_t fill_buffer = 0;
+static uint32_t fill_length = 0;
+static volatile bool dma_busy = false;
+static uart_console_stats_t console_stats;
+// Task waiting for a free buffer, notified by the DMA interrupt
+static TaskHandle_t waiting_writer = NULL;
+// One task writes at a time, so at most one waits for the DMA
+static SemaphoreHandle_t writer_lock = NULL;
+
+/**
+ * @brief Hand the buffer being filled to DMA and start filling the other
+ *        one. Called with the DMA interrupt masked, or from it.
+ *
+ * @return (void)
+ */
+static void uart_console_start_dma(void) {
+    DMA_ClearFlag(DMA1_Stream6, UART_CONSOLE_DMA_FLAGS);
+    DMA_MemoryTargetConfig(DMA1_Stream6, (uint32_t)tx_buffers[fill_buffer], DMA_Memory_0);
+    DMA_SetCurrDataCounter(DMA1_Stream6, (uint16_t)fill_length);
+    DMA_Cmd(DMA1_Stream6, ENABLE);
+    dma_busy = true;
+    console_stats.sent += fill_length;
+    console_stats.transfers++;
+    fill_buffer ^= 1;
+    fill_length = 0;
+}
+
+/**
+ * @brief Set up PA2 as USART2 TX, USART2 and DMA1 stream 6 channel 4.
+ *        Called once before the first printf.
+ *
+ * @return (void)
+ */
+void init_uart_console(void) {
+    GPIO_InitTypeDef gpio;
+    USART_InitTypeDef usart;
+    DMA_InitTypeDef dma;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_DMA1, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, ENABLE);
+
+    GPIO_PinAFConfig(GPIOA, GPIO_PinSource2, GPIO_AF_USART2);
+    GPIO_StructInit(&gpio);
+    gpio.GPIO_Pin = GPIO_Pin_2;
+    gpio.GPIO_Mode = GPIO_Mode_AF;
+    gpio.GPIO_OType = GPIO_OType_PP;
+    gpio.GPIO_PuPd = GPIO_PuPd_UP;
+    gpio.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOA, &gpio);
+
+    USART_StructInit(&usart);
+    usart.USART_BaudRate = UART_CONSOLE_BAUD_RATE;
+    usart.USART_Mode = USART_Mode_Tx;
+    USART_Init(USART2, &usart);
+
+    DMA_DeInit(DMA1_Stream6);
+    DMA_StructInit(&dma);
+    dma.DMA_Channel = DMA_Channel_4;
+    dma.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DR;
+    dma.DMA_Memory0BaseAddr = (uint32_t)tx_buffers[0];
+    dma.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    dma.DMA_BufferSize = 1;
+    dma.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_Init(DMA1_Stream6, &dma);
+    DMA_ITConfig(DMA1_Stream6, DMA_IT_TC, ENABLE);
+
+    // Masked with the kernel interrupts, so writers can hold it off
+    NVIC_SetPriority(DMA1_Stream6_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY);
+    NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+    USART_DMACmd(USART2, USART_DMAReq_Tx, ENABLE);
+    USART_Cmd(USART2, ENABLE);
+
+    writer_lock = xSemaphoreCreateMutex();
+    configASSERT(writer_lock != NULL);
+}
+
+/**
+ * @brief Queue bytes for the USART. A task waits for the DMA until all of
+ *        them are queued, and must not be in a critical section. An ISR, or
+ *        the code run before the scheduler starts, returns at once.
+ *
+ * @param ptr (const char *) [IN] The bytes
+ * @param len (int) [IN] Number of bytes
+ * @return (int) len, bytes that did not fit are counted as dropped
+ */
+int uart_console_write(const char *ptr, int len) {
+    if (len <= 0) {
+        return 0;
+    }
+    bool can_wait = __get_IPSR() == 0 && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+    if (can_wait) {
+        xSemaphoreTake(writer_lock, portMAX_DELAY);
+    }
+    uint32_t written = 0;
+    for (;;) {
+        UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+        uint32_t copied = UART_CONSOLE_BUFFER_SIZE - fill_length;
+        if (copied > (uint32_t)len - written) {
+            copied = (uint32_t)len - written;
+        }
+        memcpy(&tx_buffers[fill_buffer][fill_length], ptr + written, copied);
+        fill_length += copied;
+        written += copied;
+        if (!dma_busy && fill_length > 0) {
+            uart_console_start_dma();
+        }
+        // The buffer being filled is full, so DMA is busy and will notify
+        bool wait = can_wait && written < (uint32_t)len;
+        if (wait) {
+            waiting_writer = xTaskGetCurrentTaskHandle();
+        } else {
+            console_stats.dropped += (uint32_t)len - written;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+        if (!wait) {
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    if (can_wait) {
+        xSemaphoreGive(writer_lock);
+    }
+    return len;
+}
+
+/**
+ * @brief DMA1 stream 6 transfer complete, send what was written meanwhile.
+ *        Called from DMA1_Stream6_IRQHandler().
+ *
+ * @return (void)
+ */
+void uart_console_irq_handler(void) {
+    if (DMA_GetITStatus(DMA1_Stream6, DMA_IT_TCIF6) == RESET) {
+        return;
+    }
+    DMA_ClearITPendingBit(DMA1_Stream6, DMA_IT_TCIF6);
+    dma_busy = false;
+    if (fill_length > 0) {
+        uart_console_start_dma();
+    }
+    // The buffer being filled is empty now
+    if (waiting_writer != NULL) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(waiting_writer, &woken);
+        waiting_writer = NULL;
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+/**
+ * @brief Copy the console counters
+ *
+ * @param stats (uart_console_stats_t *) [OUT] Where to copy the counters
+ * @return (void)
+ */
+void get_uart_console_stats(uart_console_stats_t *stats) {
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    *stats = console_stats;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef UART_CONSOLE_H
+#define UART_CONSOLE_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Set to 1 to send the output of printf (_write() in syscalls.c) to
+ *        ITM stimulus port 0, which needs a debugger to read SWO
+ */
+#ifndef CONSOLE_ITM
+#define CONSOLE_ITM 1
+#endif
+
+/**
+ * @brief Set to 1 to send the output of printf to USART2 (TX on PA2) through
+ *        DMA1 stream 6. Both consoles can be on at once.
+ */
+#ifndef CONSOLE_USART
+#define CONSOLE_USART 0
+#endif
+
+#ifndef UART_CONSOLE_BAUD_RATE
+#define UART_CONSOLE_BAUD_RATE 115200
+#endif
+
+/**
+ * @brief Size of each of the two transmit buffers. While DMA sends one, the
+ *        other fills; a task writing more waits for the DMA, an ISR drops
+ *        the bytes that do not fit and counts them.
+ */
+#ifndef UART_CONSOLE_BUFFER_SIZE
+#define UART_CONSOLE_BUFFER_SIZE 512
+#endif
+
+/**
+ * @brief USART console counters
+ *
+ * @param sent (uint32_t) Bytes handed to DMA
+ * @param dropped (uint32_t) Bytes an ISR, or code run before the scheduler, found no room for
+ * @param transfers (uint32_t) DMA transfers started
+ */
+typedef struct uart_console_stats {
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t transfers;
+} uart_console_stats_t;
+
+
+void init_uart_console(void);
+int uart_console_write(const char *ptr, int len);
+void uart_console_irq_handler(void);
+void get_uart_console_stats(uart_console_stats_t *stats);
+
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * @file workload.c
+ * @brief CPU-bound work a job executes for its execution time. The job runs
+ *    a number of blocks of a kernel, computed from the cycles one block takes,
+ *    so it consumes its execution time of its own cycles: time the job spends
+ *    preempted does not count, and a job is not cut short or stretched by
+ *    where the ticks fall. init_workload() times each kernel with the DWT
+ *    cycle counter before the scheduler starts.
+ *
+ *    The simulated host build has no cycle counter and its time only moves
+ *    as tasks leave critical sections, so there a block leaves one critical
+ *    section and the blocks per ms are the quanta per ms of the port.
+ */
+
+#include "stm32f4xx.h"
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "workload.h"
+
+#ifndef DD_SIM_BUILD
+#include "dwt.h"
+#endif
+
+#define WORKLOAD_MEMORY_MASK (WORKLOAD_MEMORY_WORDS - 1)
+
+/**
+ * @brief State of the kernels, local to a job so that jobs preempting each
+ *        other do not share it
+ *
+ * @param x (uint32_t) xorshift state of WORKLOAD_INTEGER
+ * @param acc (uint32_t) Integer accumulator
+ * @param f (float) First accumulator of WORKLOAD_FPU
+ * @param g (float) Second accumulator of WORKLOAD_FPU
+ * @param index (uint32_t) Next word of WORKLOAD_MEMORY
+ */
+typedef struct workload_state {
+    uint32_t x;
+    uint32_t acc;
+    float f;
+    float g;
+    uint32_t index;
+} workload_state_t;
+
+static uint32_t workload_block_cycles[WORKLOAD_PROFILE_COUNT];
+static uint32_t workload_memory[WORKLOAD_MEMORY_WORDS];
+
+/* Results end up here, so the compiler keeps the work */
+static volatile uint32_t workload_sink;
+
+static const char *workload_names[WORKLOAD_PROFILE_COUNT] = {
+    "integer",
+    "fpu",
+    "memory"
+};
+
+/**
+ * @brief Run one block of a kernel
+ *
+ * @param profile (workload_profile_t) [IN] The kernel
+ * @param state (workload_state_t *) [IN/OUT] State of the job
+ * @return (void)
+ */
+static void workload_block(workload_profile_t profile, workload_state_t *state) {
+    switch (profile) {
+        case WORKLOAD_FPU:
+            for (uint32_t i = 0; i < WORKLOAD_BLOCK_ITERATIONS; i++) {
+                state->f = state->f * 0.999f + 0.5f;
+                state->g = state->g * 0.998f + state->f;
+            }
+            break;
+        case WORKLOAD_MEMORY:
+            for (uint32_t i = 0; i < WORKLOAD_BLOCK_ITERATIONS; i++) {
+                uint32_t word = workload_memory[state->index];
+                state->acc += word;
+                workload_memory[state->index] = word + state->acc;
+                state->index = (state->index + 1) & WORKLOAD_MEMORY_MASK;
+            }
+            break;
+        case WORKLOAD_INTEGER:
+        default:
+            for (uint32_t i = 0; i < WORKLOAD_BLOCK_ITERATIONS; i++) {
+                state->x ^= state->x << 13;
+                state->x ^= state->x >> 17;
+                state->x ^= state->x << 5;
+                state->acc += state->x * 2654435761u;
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Run a number of blocks, the loop timed by the calibration and run by
+ *        the jobs
+ *
+ * @param profile (workload_profile_t) [IN] The kernel
+ * @param blocks (uint64_t) [IN] Blocks to run
+ * @param cancelled (const volatile bool *) [IN] Checked between blocks, stops the work once set
+ * @return (bool) false if cancelled before the end
+ */
+static bool workload_blocks(workload_profile_t profile, uint64_t blocks, const volatile bool *cancelled) {
+    workload_state_t state = { 2463534242u, 0, 1.0f, 1.0f, 0 };
+    bool done = true;
+
+    for (uint64_t block = 0; block < blocks; block++) {
+        if (*cancelled) {
+            done = false;
+            break;
+        }
+        workload_block(profile, &state);
+#ifdef DD_SIM_BUILD
+        // One quantum of simulated time
+        taskENTER_CRITICAL();
+        taskEXIT_CRITICAL();
+#endif
+    }
+    workload_sink = state.acc + (uint32_t)state.g;
+    return done;
+}
+
+/**
+ * @brief Time a block of each kernel. Called before the scheduler starts.
+ *
+ * @return (void)
+ */
+void init_workload(void) {
+    for (uint32_t i = 0; i < WORKLOAD_MEMORY_WORDS; i++) {
+        workload_memory[i] = i;
+    }
+#ifdef DD_SIM_BUILD
+    // Nothing to time, a block is one quantum of simulated time whatever
+    // the kernel, so every profile gets the same cycles
+    for (uint32_t profile = 0; profile < WORKLOAD_PROFILE_COUNT; profile++) {
+        workload_block_cycles[profile] = SystemCoreClock / (configTICK_RATE_HZ * configSIM_QUANTA_PER_TICK);
+    }
+#else
+    static const volatile bool never = false;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+    for (uint32_t profile = 0; profile < WORKLOAD_PROFILE_COUNT; profile++) {
+        // A first pass fills the caches and the flash prefetch buffer
+        workload_blocks((workload_profile_t)profile, 1, &never);
+        uint32_t start = DWT_CYCCNT;
+        workload_blocks((workload_profile_t)profile, WORKLOAD_CALIBRATION_BLOCKS, &never);
+        uint32_t cycles = (DWT_CYCCNT - start) / WORKLOAD_CALIBRATION_BLOCKS;
+        workload_block_cycles[profile] = cycles > 0 ? cycles : 1;
+    }
+#endif
+}
+
+/**
+ * @brief Execute a kernel for a time, counted in cycles of the caller and
+ *        not in wall clock time
+ *
+ * @param profile (workload_profile_t) [IN] The kernel
+ * @param ms (uint32_t) [IN] Execution time
+ * @param cancelled (const volatile bool *) [IN] Checked between blocks, stops the work once set
+ * @return (bool) false if cancelled before the end
+ */
+bool workload_run(workload_profile_t profile, uint32_t ms, const volatile bool *cancelled) {
+    if (profile >= WORKLOAD_PROFILE_COUNT) {
+        profile = WORKLOAD_INTEGER;
+    }
+    uint64_t cycles = (uint64_t)ms * (SystemCoreClock / 1000);
+    return workload_blocks(profile, cycles / workload_block_cycles[profile], cancelled);
+}
+
+/**
+ * @brief Cycles a block of a kernel takes, as calibrated. Only measured on
+ *        the target, the simulated build gives the cycles of a quantum.
+ *
+ * @param profile (workload_profile_t) [IN] The kernel
+ * @return (uint32_t) Cycles, 0 if profile is not a kernel
+ */
+uint32_t get_workload_block_cycles(workload_profile_t profile) {
+    return profile < WORKLOAD_PROFILE_COUNT ? workload_block_cycles[profile] : 0;
+}
+
+/**
+ * @brief Name of a kernel, for the monitor
+ *
+ * @param profile (workload_profile_t) [IN] The kernel
+ * @return (const char *) The name
+ */
+const char *get_workload_name(workload_profile_t profile) {
+    return profile < WORKLOAD_PROFILE_COUNT ? workload_names[profile] : "?";
+}
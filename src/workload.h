@@ -0,0 +1,58 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Kernel iterations in one block of work. The job checks for
+ *        cancellation between blocks, so this bounds how long an overdue job
+ *        keeps running.
+ */
+#ifndef WORKLOAD_BLOCK_ITERATIONS
+#define WORKLOAD_BLOCK_ITERATIONS 64
+#endif
+
+/**
+ * @brief Blocks timed per profile by init_workload()
+ */
+#ifndef WORKLOAD_CALIBRATION_BLOCKS
+#define WORKLOAD_CALIBRATION_BLOCKS 256
+#endif
+
+/**
+ * @brief Words of the buffer streamed by WORKLOAD_MEMORY, must be a power of
+ *        two
+ */
+#ifndef WORKLOAD_MEMORY_WORDS
+#define WORKLOAD_MEMORY_WORDS 1024
+#endif
+
+#if (WORKLOAD_MEMORY_WORDS & (WORKLOAD_MEMORY_WORDS - 1)) != 0
+#error "WORKLOAD_MEMORY_WORDS must be a power of two"
+#endif
+
+/**
+ * @brief Kind of work a job executes
+ *
+ * @param WORKLOAD_INTEGER Integer multiply and shifts, in registers
+ * @param WORKLOAD_FPU Single precision multiply-adds on the FPU
+ * @param WORKLOAD_MEMORY Read-modify-write streaming over a RAM buffer
+ * @param WORKLOAD_PROFILE_COUNT Number of profiles
+ */
+typedef enum workload_profile {
+    WORKLOAD_INTEGER,
+    WORKLOAD_FPU,
+    WORKLOAD_MEMORY,
+    WORKLOAD_PROFILE_COUNT
+} workload_profile_t;
+
+
+void init_workload(void);
+bool workload_run(workload_profile_t profile, uint32_t ms, const volatile bool *cancelled);
+uint32_t get_workload_block_cycles(workload_profile_t profile);
+const char *get_workload_name(workload_profile_t profile);
+
+
+#endif